@@ -13,15 +13,20 @@
 #include "program_constants.h" /* for the ProgramState struct */
 
 /**
- * Parses an AM file and generates a binary output file.
+ * Parses the tokenized lines of an AM file into the statements of the program,
+ * reporting their errors.
  *
- * @param am_file_name The name of the input file to parse.
- * @param bin_file_name The name of the binary output file to generate.
  * @param programState A pointer to the current state of the program.
  *
  * @return Status indicating success or failure of the operation.
  */
-Status
-ParseFile(char *am_file_name, char *bin_file_name, ProgramState *programState);
+Status ParseFile(ProgramState *programState);
+
+/**
+ * Encodes the statements of the program into its word images.
+ *
+ * @param programState A pointer to the current state of the program.
+ */
+void EncodeFile(ProgramState *programState);
 
 #endif
@@ -0,0 +1,127 @@
+/*********************************FILE__HEADER*********************************\
+* File:					arena.c
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			Implementation of the Arena, a list of memory blocks
+*                       that objects are allocated from by bumping an offset.
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "arena.h"
+#include "utils.h" /* for my_malloc */
+
+/****************************** Type  Definitions *****************************/
+/* A type with the strictest alignment of the objects allocated from arenas */
+typedef union {
+    long l;
+    double d;
+    void *p;
+} ArenaAlign;
+
+/* The offset of the bytes of a block, aligned after its struct */
+#define ARENA_HEADER_SIZE \
+    ((sizeof(ArenaBlock) + sizeof(ArenaAlign) - 1) / sizeof(ArenaAlign) * \
+     sizeof(ArenaAlign))
+
+/************************* Functions  Implementations *************************/
+/**
+ * Allocates a new arena block.
+ * In case of an memory allocation error the program will exit.
+ *
+ * @param size - The number of bytes of the block.
+ * @return A pointer to the new block.
+ */
+ArenaBlock *new_arena_block(size_t size) {
+    ArenaBlock *block = my_malloc(ARENA_HEADER_SIZE + size);
+    if (block == NULL) {
+        fprintf(stderr, "Error allocating memory for an arena block\n");
+        exit(1);
+    }
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+/******************************************************************************/
+/**
+ * Allocates and initializes a new, empty Arena.
+ * If memory allocation fails, the function prints an error message to stderr
+ * and exits with a status code of 1.
+ *
+ * @return a pointer to the newly created Arena.
+ */
+Arena *new_arena() {
+    Arena *arena = my_malloc(sizeof(Arena));
+    if (arena == NULL) {
+        fprintf(stderr, "Error allocating memory for an arena\n");
+        exit(1);
+    }
+    arena->first = new_arena_block(ARENA_BLOCK_SIZE);
+    arena->current = arena->first;
+    return arena;
+}
+/******************************************************************************/
+/**
+ * Allocates memory from the current block of the arena. When it is full, the
+ * next block is used, and a new block is added after the current one only if
+ * the next block is too small as well.
+ *
+ * @param arena - The arena.
+ * @param size - The number of bytes to allocate.
+ * @return A pointer to the allocated memory.
+ */
+void *arena_alloc(Arena *arena, size_t size) {
+    ArenaBlock *block = arena->current;
+    ArenaBlock *newBlock = NULL;
+    void *memory = NULL;
+
+    /* Keep every allocation aligned */
+    size = (size + sizeof(ArenaAlign) - 1) / sizeof(ArenaAlign) *
+           sizeof(ArenaAlign);
+
+    if (block->size - block->used < size) {
+        block = block->next;
+        if (block == NULL || block->size < size) {
+            newBlock = new_arena_block(size > ARENA_BLOCK_SIZE ?
+                                       size : ARENA_BLOCK_SIZE);
+            newBlock->next = arena->current->next;
+            arena->current->next = newBlock;
+            block = newBlock;
+        }
+        block->used = 0;
+        arena->current = block;
+    }
+
+    memory = (char *) block + ARENA_HEADER_SIZE + block->used;
+    block->used += size;
+    return memory;
+}
+/******************************************************************************/
+/**
+ * Releases all the memory allocated from the arena, keeping its blocks.
+ *
+ * @param arena - The arena.
+ */
+void reset_arena(Arena *arena) {
+    arena->current = arena->first;
+    arena->first->used = 0;
+}
+/******************************************************************************/
+/**
+ * Frees the arena and all its blocks.
+ *
+ * @param arena - The arena.
+ */
+void free_arena(Arena *arena) {
+    ArenaBlock *block = arena->first, *next = NULL;
+    while (block != NULL) {
+        next = block->next;
+        my_free(block);
+        block = next;
+    }
+    my_free(arena);
+}
+/******************************************************************************/
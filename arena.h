@@ -0,0 +1,69 @@
+/*********************************FILE__HEADER*********************************\
+* File:					arena.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			API of the Arena, a bump allocator for objects that are
+*                       all released together. Resetting an arena keeps its
+*                       memory, so objects of the next file processed are
+*                       allocated without calling malloc again.
+\******************************************************************************/
+
+#ifndef MAMAN14_ARENA_H
+#define MAMAN14_ARENA_H
+
+#include <stddef.h> /* for size_t */
+
+/***************************** Global Definitions *****************************/
+/* The size of an arena block, larger objects get a block of their own */
+#define ARENA_BLOCK_SIZE 16384
+
+/**************************** Structs  Definitions ****************************/
+/* A block of arena memory, its bytes follow the struct */
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size; /* The number of bytes of the block */
+    size_t used; /* The number of bytes allocated from the block */
+} ArenaBlock;
+
+/* A list of blocks, allocated from in order */
+typedef struct {
+    ArenaBlock *first;
+    ArenaBlock *current; /* The block allocations are made from */
+} Arena;
+
+/************************* Functions Declarations *************************/
+/**
+ * Creates a new, empty arena.
+ * In case of an memory allocation error the program will exit.
+ *
+ * @return A pointer to the new arena.
+ */
+Arena *new_arena();
+
+/**
+ * Allocates memory from the arena, aligned for any type. The memory is valid
+ * until the arena is reset or freed.
+ * In case of an memory allocation error the program will exit.
+ *
+ * @param arena - The arena.
+ * @param size - The number of bytes to allocate.
+ * @return A pointer to the allocated memory.
+ */
+void *arena_alloc(Arena *arena, size_t size);
+
+/**
+ * Releases all the memory allocated from the arena at once, keeping its
+ * blocks for the next allocations.
+ *
+ * @param arena - The arena.
+ */
+void reset_arena(Arena *arena);
+
+/**
+ * Frees the arena and all its blocks.
+ *
+ * @param arena - The arena.
+ */
+void free_arena(Arena *arena);
+
+#endif
@@ -26,17 +26,22 @@
 #include <stdio.h>
 
 #include "program_constants.h"
+#include "program_state.h"
 #include "macro_processing.h"
 #include "label_processing.h"
 #include "am_file_processing.h"
 #include "binary_and_ob_processing.h"
 #include "utils.h"
+#include "options.h"
+#include "include_cache.h"
+#include "output_encoders.h"
+#include "mem_report.h"
+#include "stats.h"
+#include "hw_counters.h"
+#include "trace.h"
+#include "print_error.h"
 
 /**************************** Forward Declarations ****************************/
-void initProgramState(ProgramState *);
-
-void freeProgramState(ProgramState *programState);
-
 void freeAllFiles(char *, char *, char *, char *, char *, char *);
 /******************************************************************************/
 /******************************* Main  Function *******************************/
@@ -45,134 +50,257 @@ void freeAllFiles(char *, char *, char *, char *, char *, char *);
  *    1. Initiation of the program state. The assumption of the program is that the starting memory block is
  *       located at address '100'.
  *    2. Reading files and appending appropriate extensions(.am, .ext, .ent, .ob).
+ *       If a macro library was given (--macro-lib), it is built once and its macros
+ *       are available to every file. Files named by '.include' are preprocessed once
+ *       per run as well, and shared by every file including them.
  *    3. Preprocessing: reading and expanding macros.
- *    4. Checking labels for any discrepancies.
- *    5. Parsing files to understand and validate the syntax.
+ *    4. Checking labels for any discrepancies. In one-pass mode (--one-pass) this is
+ *       done while parsing instead, as the definition of each label is reached.
+ *    5. Parsing files to understand and validate the syntax, encoding them into
+ *       in-memory code and data images, sized up front. The words referring to
+ *       labels are patched once all the labels are known.
  *    6. Writing all labels, both entry & external to separated files(.ext, .ent).
- *    7. Conversion from binary to base64 and save in a file (.ob).
+ *    7. Conversion from binary to base64 and save in a file (.ob), or to the output
+ *       formats selected by --format, and optionally to a packed binary object
+ *       file (.obj, --binary-object).
  *       Note: If any of the stages encounters an error or fails, the program will not produce a base64 *.ob file.
- *    8. Finally, freeing the program state after processing.
+ *       With --check, the file is only validated: its errors are reported, but it is not
+ *       encoded and no file is written, not even the .am file. With --max-errors N (or
+ *       --fail-fast, for 1), the processing of a file stops at its N-th error.
+ *    8. Finally, resetting the program state for the next file, keeping its memory, so
+ *       that once the buffers have grown to the size of the files, assembling another
+ *       file doesn't allocate memory. The program state is freed after the last file.
+ *       With --mem-report, the allocations made by each stage are printed at exit, and
+ *       with --stats, the timings and counters of each file and of the whole run, and
+ *       with --hw-counters, the hardware counters of each stage. With --trace, a timeline
+ *       of the files and stages is written in the Chrome trace event format.
  *
  * @param argc - The number of command-line arguments.
- * @param argv[] - An array of command-line arguments, which are expected to be names of the files to be processed.
+ * @param argv[] - An array of command-line arguments, which are expected to be names of the files to be processed,
+ *                 optionally mixed with options (see options.h).
  *
- * @return int - Returns 0 on successful execution.
+ * @return int - Returns 0 on successful execution. With --check, returns 1 if any file
+ *               has errors.
  */
 int main(int argc, char *argv[]) {
     /* Initialization of structures and variables */
     ProgramState programState;
+    Options options;
+    MacroVector *macroLibrary = NULL;
+    Arena *libraryArena = NULL;
+    Vector *includeCache = NULL;
     Status stages_status = SUCCESS;
+    Status reports_status = SUCCESS;
+    int num_of_failed_files = 0;
     FILE *file = NULL;
-    int i = 0;
+    int i = 0, format = 0;
+    size_t argLength = 0, maxLength = 0;
+#ifdef REPORT_ALLOCATIONS
+    long allocations = 0;
+#endif
 
     char *file_name_as = NULL, *file_name_am = NULL, *file_name_ent = NULL,
-            *file_name_ext = NULL, *file_name_bin = NULL, *file_name_ob = NULL;
+            *file_name_ext = NULL, *file_name_obj = NULL,
+            *file_name_out = NULL;
+
+    /* Separate the options from the names of the files to process */
+    if (SUCCESS != parseOptions(argc, argv, &options)) {
+        freeOptions(&options);
+        return FAILURE;
+    }
 
     /* validate that at least one file for processing was provided */
-    if (argc < 2) {
+    if (options.num_of_files < 1) {
         printf("Please provide file names as command-line arguments.\n");
+        freeOptions(&options);
         return FAILURE;
     }
 
-    for (i = 1; i < argc; i++) {
-        size_t argLength = strlen(argv[i]);
-
-        /* Memory allocation with validation */
-        if ((file_name_as = malloc(argLength + 4)) == NULL ||
-            /* 4 for ".as\0" */
-            (file_name_am = malloc(argLength + 4)) == NULL ||
-            /* 4 for ".am\0" */
-            (file_name_ent = malloc(argLength + 5)) == NULL ||
-            /* 5 for ".ent\0" */
-            (file_name_ext = malloc(argLength + 5)) == NULL ||
-            /* 5 for ".ext\0" */
-            (file_name_bin = malloc(argLength + 5)) == NULL ||
-            /* 5 for ".bin\0" */
-            (file_name_ob = malloc(argLength + 4)) ==
-            NULL) {   /* 4 for ".ob\0" */
-            printf("Error: Memory allocation for info files was failed!\n");
-            exit(1);
+    if (options.trace_file != NULL) {
+        trace_enable(options.trace_file);
+    }
+    stats_enable((StatsFormat) options.stats, options.stats_file);
+
+    /* Build the macro library once, it is shared by all the files */
+    if (options.macro_lib_file != NULL) {
+        macroLibrary = new_macro_vector();
+        libraryArena = new_arena();
+        if (SUCCESS != buildMacroLibrary(options.macro_lib_file,
+                                         macroLibrary, libraryArena)) {
+            free_shared_macros(macroLibrary);
+            free_arena(libraryArena);
+            freeOptions(&options);
+            return FAILURE;
+        }
+    }
+
+    /* Files included by '.include' are preprocessed once and shared by all the files */
+    includeCache = new_vector();
+
+    /* The file names are built in the same buffers for all the files */
+    for (i = 0; i < options.num_of_files; i++) {
+        argLength = strlen(options.file_names[i]);
+        if (argLength > maxLength) {
+            maxLength = argLength;
         }
+    }
+
+    /* Memory allocation with validation */
+    if ((file_name_as = my_malloc(maxLength + 4)) == NULL ||
+        /* 4 for ".as\0" */
+        (file_name_am = my_malloc(maxLength + 4)) == NULL ||
+        /* 4 for ".am\0" */
+        (file_name_ent = my_malloc(maxLength + 5)) == NULL ||
+        /* 5 for ".ent\0" */
+        (file_name_ext = my_malloc(maxLength + 5)) == NULL ||
+        /* 5 for ".ext\0" */
+        (file_name_obj = my_malloc(maxLength + 5)) == NULL ||
+        /* 5 for ".obj\0" */
+        (file_name_out = my_malloc(maxLength + MAX_OUTPUT_EXTENSION_LENGTH +
+                                   1)) == NULL) {
+        printf("Error: Memory allocation for info files was failed!\n");
+        exit(1);
+    }
+
+    if (options.hw_counters) {
+        hw_counters_enable();
+    }
+
+    /* The program state is allocated once, and reset for every file */
+    initProgramState(&programState);
+    programState.includeCache = includeCache;
+    programState.onePass = options.one_pass;
+
+    for (i = 0; i < options.num_of_files; i++) {
+        char *fileName = options.file_names[i];
+#ifdef REPORT_ALLOCATIONS
+        allocations = get_num_of_allocations();
+#endif
 
         /* Construct file names with proper extensions */
-        sprintf(file_name_as, "%s.as", argv[i]);
-        sprintf(file_name_am, "%s.am", argv[i]);
-        sprintf(file_name_ent, "%s.ent", argv[i]);
-        sprintf(file_name_ext, "%s.ext", argv[i]);
-        sprintf(file_name_bin, "%s.bin", argv[i]);
-        sprintf(file_name_ob, "%s.ob", argv[i]);
+        sprintf(file_name_as, "%s.as", fileName);
+        sprintf(file_name_am, "%s.am", fileName);
+        sprintf(file_name_ent, "%s.ent", fileName);
+        sprintf(file_name_ext, "%s.ext", fileName);
+        sprintf(file_name_obj, "%s.obj", fileName);
 
         /* File opening with validation */
         if ((file = fopen(file_name_as, "r")) == NULL) {
             printf("Failed to open the file: %s\n", file_name_as);
-            freeAllFiles(file_name_as, file_name_am, file_name_ent,
-                         file_name_ext, file_name_bin, file_name_ob);
+            num_of_failed_files++;
             continue;  /* Skip to the next file */
         }
 
-        /* Initialize program state settings */
-        initProgramState(&programState);
+        /* Reset the program state left by the previous file */
+        resetProgramState(&programState);
+        stats_begin_file();
+        StartFileErrors(options.max_errors);
+        stages_status = SUCCESS;
+        if (macroLibrary != NULL) {
+            seed_macro_vector(programState.macros, macroLibrary);
+        }
 
         /* Process the file */
-        stages_status += preProcess(file_name_as, file_name_am, &programState);
+        set_mem_stage(MEM_STAGE_PRE_PROCESS);
+        stats_start_stage(STATS_STAGE_PRE_PROCESS);
+        stages_status += preProcess(file_name_as,
+                                    options.check ? NULL : file_name_am,
+                                    &programState);
+        stats_end_stage(STATS_STAGE_PRE_PROCESS);
         if (SUCCESS != stages_status) {
-            remove(file_name_am);
+            if (!options.check) {
+                remove(file_name_am);
+            }
         } else {
-            stages_status += checkLabels(file_name_am, &programState);
-            stages_status += ParseFile(file_name_am, file_name_bin,
-                                       &programState);
+            /* In one pass, the labels are checked while the file is parsed */
+            if (!programState.onePass) {
+                set_mem_stage(MEM_STAGE_CHECK_LABELS);
+                stats_start_stage(STATS_STAGE_CHECK_LABELS);
+                stages_status += checkLabels(&programState);
+                stats_end_stage(STATS_STAGE_CHECK_LABELS);
+            }
+            if (!ErrorLimitReached()) {
+                set_mem_stage(MEM_STAGE_PARSE);
+                stats_start_stage(STATS_STAGE_PARSE);
+                stages_status += ParseFile(&programState);
+                /* The words of a file only checked, or with errors, would be
+                 * thrown away, so only its references to labels are checked */
+                if (options.check || SUCCESS != stages_status) {
+                    stages_status += CheckReferences(&programState);
+                } else {
+                    EncodeFile(&programState);
+                    stages_status += ResolveFixups(&programState);
+                }
+                stats_end_stage(STATS_STAGE_PARSE);
+            }
             /** Only if all previous stages (pre process, syntax validation and parsing) were successful,
              * write labels to file and convert binary to Base64 */
-            if (SUCCESS == stages_status) {
+            if (SUCCESS == stages_status && !options.check) {
+                set_mem_stage(MEM_STAGE_OUTPUT);
+                stats_start_stage(STATS_STAGE_WRITE_LABELS);
                 WriteLabelsToFile(file_name_ent, file_name_ext, &programState);
-                binaryToBase64(file_name_bin, file_name_ob, programState.IC,
-                               programState.DC);
+                stats_end_stage(STATS_STAGE_WRITE_LABELS);
+                stats_start_stage(STATS_STAGE_OUTPUT);
+                for (format = 0; format < numOfOutputEncoders(); format++) {
+                    if (options.output_formats & (1U << format)) {
+                        sprintf(file_name_out, "%s%s", fileName,
+                                getOutputEncoder(format)->extension);
+                        writeEncodedOutput(getOutputEncoder(format),
+                                           file_name_out, programState.code,
+                                           programState.data);
+                    }
+                }
+                if (options.binary_object) {
+                    writeBinaryObject(file_name_obj, &programState);
+                }
+                stats_end_stage(STATS_STAGE_OUTPUT);
             }
         }
 
-        remove(file_name_bin);
+        if (SUCCESS != stages_status) {
+            num_of_failed_files++;
+        }
+        if (ErrorLimitReached()) {
+            printf("Too many errors, stopped processing %s.\n", file_name_as);
+        }
         fclose(file);
-        freeAllFiles(file_name_as, file_name_am, file_name_ent, file_name_ext,
-                     file_name_bin, file_name_ob);
-
-        /* Free the program state */
-        freeProgramState(&programState);
+        stats_end_file(file_name_as, programState.amLines->size,
+                       programState.labels.size, programState.IC,
+                       programState.DC);
+#ifdef REPORT_ALLOCATIONS
+        printf("%s: %ld allocations\n", file_name_as,
+               get_num_of_allocations() - allocations);
+#endif
     }
 
-    return 0;
-}
-/******************************************************************************/
-/**
- * Initializes a ProgramState structure by allocating memory for the
- * labels and externalLabels vectors and setting initial values for all members.
- *
- * @param programState - A pointer to the ProgramState structure to initialize.
- */
-void initProgramState(ProgramState *programState) {
-    programState->labels = new_vector();
-    programState->externalLabels = new_vector();
-    programState->IC = 0;
-    programState->DC = 0;
-    programState->current_line_number = 100; /* assumed starting memory block address */
-}
-/******************************************************************************/
-/**
- * Frees up allocated memory for labels and external labels,
- * to prevent memory leaks and manage memory of dynamic memory allocated arrays
- * in the program.
- *
- * @param programState - Pointer to the ProgramState object to be freed.
- */
-void freeProgramState(ProgramState *programState) {
-    if (programState->labels != NULL) {
-        free_vector(programState->labels);
-        programState->labels = NULL; /* Set the pointer to NULL to avoid dangling pointer */
-    }
+    /* Free the program state and the file names */
+    set_mem_stage(MEM_STAGE_CLEANUP);
+    freeProgramState(&programState);
+    freeAllFiles(file_name_as, file_name_am, file_name_ent, file_name_ext,
+                 file_name_obj, file_name_out);
 
-    if (programState->externalLabels != NULL) {
-        free_vector(programState->externalLabels);
-        programState->externalLabels = NULL; /* Set the pointer to NULL to avoid dangling pointer */
+    if (macroLibrary != NULL) {
+        free_shared_macros(macroLibrary);
+        free_arena(libraryArena);
+    }
+    freeIncludeCache(includeCache);
+    reports_status = stats_end_run();
+    if (SUCCESS != trace_write()) {
+        reports_status = FAILURE;
     }
+    if (options.mem_report) {
+        print_mem_report(stdout);
+    }
+    /* A check fails if any file has errors, e.g. to stop a commit, and any
+     * run fails if a report couldn't be written */
+    if ((options.check && num_of_failed_files > 0) ||
+        SUCCESS != reports_status) {
+        freeOptions(&options);
+        return FAILURE;
+    }
+    freeOptions(&options);
+
+    return 0;
 }
 /******************************************************************************/
 /**
@@ -182,17 +310,17 @@ void freeProgramState(ProgramState *programState) {
  * @param file_name_am  - Pointer to the string used for the ".am" file name.
  * @param file_name_ent - Pointer to the string used for the ".ent" file name.
  * @param file_name_ext - Pointer to the string used for the ".ext" file name.
- * @param file_name_bin - Pointer to the string used for the ".bin" file name.
- * @param file_name_ob  - Pointer to the string used for the ".ob" file name.
+ * @param file_name_obj - Pointer to the string used for the ".obj" file name.
+ * @param file_name_out - Pointer to the string used for the output format file names.
  */
 void freeAllFiles(char *file_name_as, char *file_name_am, char *file_name_ent,
-                  char *file_name_ext, char *file_name_bin,
-                  char *file_name_ob) {
-    free(file_name_as);
-    free(file_name_am);
-    free(file_name_ent);
-    free(file_name_ext);
-    free(file_name_bin);
-    free(file_name_ob);
+                  char *file_name_ext, char *file_name_obj,
+                  char *file_name_out) {
+    my_free(file_name_as);
+    my_free(file_name_am);
+    my_free(file_name_ent);
+    my_free(file_name_ext);
+    my_free(file_name_obj);
+    my_free(file_name_out);
 }
 /******************************************************************************/
\ No newline at end of file
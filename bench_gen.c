@@ -0,0 +1,466 @@
+/*********************************FILE__HEADER*********************************\
+* File:                 bench_gen.c
+* Authors:              Daniel Brodsky & Lior Katav
+* Date:                 August-2023
+* Description:          This file is a workload generator, separate from the
+*                       assembler. It writes a valid assembly program of the
+*                       given shape, for measuring the assembler on inputs
+*                       larger than the examples in tests/. The program is
+*                       determined by the seed and the shape alone: the
+*                       generator has its own random number generator, so
+*                       the same arguments write the same file everywhere.
+*
+*                       Usage: bench_gen [options] <output file>
+*                       --seed <n>            The seed (1).
+*                       --lines <n>           The statement lines (1000),
+*                                             not counting the .extern and
+*                                             .entry lines and the macro
+*                                             definitions.
+*                       --label-density <%>   The lines defining a label (20).
+*                       --extern-ratio <%>    The label operands referring to
+*                                             an extern symbol (10).
+*                       --externs <n>         The extern symbols declared
+*                                             (1 for every 50 lines, if the
+*                                             extern ratio isn't 0).
+*                       --entry-ratio <%>     The labels declared .entry (5).
+*                       --macros <n>          The macros defined (0).
+*                       --expansion <n>       The lines of each macro (4).
+*                       --macro-calls <%>     The lines invoking a macro (10).
+*                       --data <%>            The .data lines (10).
+*                       --data-length <n>     The numbers of each .data line,
+*                                             up to 128 (1 to 6 at random).
+*                       --string <%>          The .string lines (5).
+*                       --register-pairs <%>  The two operand commands whose
+*                                             operands are both registers (20).
+*
+*                       The commands and their addressing modes are those of
+*                       the default isa.def.
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******************************** Definitions *********************************/
+/* Operand addressing modes, as a set of bits */
+#define MODE_IMMEDIATE 1
+#define MODE_DIRECT 2
+#define MODE_REGISTER 4
+
+#define NUM_OF_REGISTERS 7
+
+/* The ranges of an immediate operand (10 bits) and of a .data number (12 bits) */
+#define MIN_IMMEDIATE (-512)
+#define MAX_IMMEDIATE 511
+#define MIN_DATA_NUMBER (-2048)
+#define MAX_DATA_NUMBER 2047
+
+#define MAX_DATA_NUMBERS 6
+/* The most numbers of a .data line that fit in a source line */
+#define MAX_DATA_LENGTH 128
+#define MAX_STRING_LENGTH 12
+
+/* A source line of statement, by what it holds */
+typedef enum {
+    LINE_COMMAND,
+    LINE_DATA,
+    LINE_STRING,
+    LINE_MACRO_CALL
+} LineKind;
+
+/**************************** Structs  Definitions ****************************/
+typedef struct {
+    const char *mnemonic;
+    int sourceModes; /* 0 for a command without a source operand */
+    int targetModes; /* 0 for a command without operands */
+} Command;
+
+/* The shape of the generated program */
+typedef struct {
+    unsigned long seed;
+    long lines;
+    int labelDensity;
+    int externRatio;
+    long externs; /* -1 for 1 for every 50 lines */
+    int entryRatio;
+    long macros;
+    long expansion;
+    int macroCalls;
+    int data;
+    long dataLength; /* 0 for 1 to MAX_DATA_NUMBERS at random */
+    int string;
+    int registerPairs;
+} Shape;
+
+/******************* Global variable definitions ******************************/
+static const Command commands[] = {
+        {"mov",  MODE_IMMEDIATE | MODE_DIRECT | MODE_REGISTER,
+                 MODE_DIRECT | MODE_REGISTER},
+        {"cmp",  MODE_IMMEDIATE | MODE_DIRECT | MODE_REGISTER,
+                 MODE_IMMEDIATE | MODE_DIRECT | MODE_REGISTER},
+        {"add",  MODE_IMMEDIATE | MODE_DIRECT | MODE_REGISTER,
+                 MODE_DIRECT | MODE_REGISTER},
+        {"sub",  MODE_IMMEDIATE | MODE_DIRECT | MODE_REGISTER,
+                 MODE_DIRECT | MODE_REGISTER},
+        {"not",  0, MODE_DIRECT | MODE_REGISTER},
+        {"clr",  0, MODE_DIRECT | MODE_REGISTER},
+        {"lea",  MODE_DIRECT, MODE_DIRECT | MODE_REGISTER},
+        {"inc",  0, MODE_DIRECT | MODE_REGISTER},
+        {"dec",  0, MODE_DIRECT | MODE_REGISTER},
+        {"jmp",  0, MODE_DIRECT | MODE_REGISTER},
+        {"bne",  0, MODE_DIRECT | MODE_REGISTER},
+        {"red",  0, MODE_DIRECT | MODE_REGISTER},
+        {"prn",  0, MODE_IMMEDIATE | MODE_DIRECT | MODE_REGISTER},
+        {"jsr",  0, MODE_DIRECT | MODE_REGISTER},
+        {"rts",  0, 0},
+        {"stop", 0, 0}
+};
+static const int commandsSize = sizeof(commands) / sizeof(Command);
+
+/* The state of the random number generator */
+static unsigned long randomState = 1;
+
+/* The lines defining a label, and the number of extern symbols */
+static long *labelLines = NULL;
+static long labelsSize = 0;
+static long externsSize = 0;
+
+/************************* Functions  Implementations *************************/
+/**
+ * Returns the next random number of the generator, a 32 bits xorshift,
+ * which gives the same sequence on every platform.
+ */
+unsigned long nextRandom(void) {
+    randomState ^= (randomState << 13) & 0xFFFFFFFFUL;
+    randomState ^= randomState >> 17;
+    randomState ^= (randomState << 5) & 0xFFFFFFFFUL;
+    return randomState;
+}
+/******************************************************************************/
+/**
+ * Returns a random number between min and max, inclusive.
+ */
+long randomBetween(long min, long max) {
+    return min + (long) (nextRandom() % (unsigned long) (max - min + 1));
+}
+/******************************************************************************/
+/**
+ * Returns 1 with the given percentage of chance, and 0 otherwise.
+ */
+int randomChance(int percentage) {
+    return randomBetween(0, 99) < percentage;
+}
+/******************************************************************************/
+/**
+ * Prints the error, if there is one, and the usage, and exits.
+ */
+void usageError(const char *program, const char *message) {
+    if (message != NULL) {
+        fprintf(stderr, "bench_gen: %s\n", message);
+    }
+    fprintf(stderr, "Usage: %s [--seed <n>] [--lines <n>] [--label-density <%%>]"
+                    " [--extern-ratio <%%>] [--externs <n>] [--entry-ratio <%%>]"
+                    " [--macros <n>] [--expansion <n>] [--macro-calls <%%>]"
+                    " [--data <%%>] [--data-length <n>] [--string <%%>]"
+                    " [--register-pairs <%%>] <output file>\n",
+            program);
+    exit(1);
+}
+/******************************************************************************/
+/**
+ * Parses a non negative number of the arguments, which is a percentage
+ * unless maximum is 0.
+ */
+long parseNumber(const char *program, const char *option, const char *text,
+                 long maximum) {
+    char *end;
+    long value = strtol(text, &end, 10);
+
+    if (*text == '\0' || *end != '\0' || value < 0 ||
+        (maximum > 0 && value > maximum)) {
+        fprintf(stderr, "bench_gen: Invalid value '%s' of %s\n", text, option);
+        usageError(program, NULL);
+    }
+    return value;
+}
+/******************************************************************************/
+/**
+ * Parses the arguments into the shape, and returns the output file name.
+ */
+const char *parseArguments(int argc, char *argv[], Shape *shape) {
+    const char *output = NULL;
+    const char *option;
+    long value;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        option = argv[i];
+        if (strncmp(option, "--", 2) != 0) {
+            if (output != NULL) {
+                usageError(argv[0], "More than one output file");
+            }
+            output = option;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usageError(argv[0], "Missing the value of an option");
+        }
+        value = parseNumber(argv[0], option, argv[++i],
+                            strcmp(option, "--seed") == 0 ||
+                            strcmp(option, "--lines") == 0 ||
+                            strcmp(option, "--externs") == 0 ||
+                            strcmp(option, "--macros") == 0 ||
+                            strcmp(option, "--expansion") == 0 ? 0 :
+                            strcmp(option, "--data-length") == 0 ?
+                            MAX_DATA_LENGTH : 100);
+        if (strcmp(option, "--seed") == 0) {
+            shape->seed = (unsigned long) value;
+        } else if (strcmp(option, "--lines") == 0) {
+            shape->lines = value;
+        } else if (strcmp(option, "--label-density") == 0) {
+            shape->labelDensity = (int) value;
+        } else if (strcmp(option, "--extern-ratio") == 0) {
+            shape->externRatio = (int) value;
+        } else if (strcmp(option, "--externs") == 0) {
+            shape->externs = value;
+        } else if (strcmp(option, "--entry-ratio") == 0) {
+            shape->entryRatio = (int) value;
+        } else if (strcmp(option, "--macros") == 0) {
+            shape->macros = value;
+        } else if (strcmp(option, "--expansion") == 0) {
+            shape->expansion = value;
+        } else if (strcmp(option, "--macro-calls") == 0) {
+            shape->macroCalls = (int) value;
+        } else if (strcmp(option, "--data") == 0) {
+            shape->data = (int) value;
+        } else if (strcmp(option, "--data-length") == 0) {
+            shape->dataLength = value;
+        } else if (strcmp(option, "--string") == 0) {
+            shape->string = (int) value;
+        } else if (strcmp(option, "--register-pairs") == 0) {
+            shape->registerPairs = (int) value;
+        } else {
+            usageError(argv[0], "Unknown option");
+        }
+    }
+    if (output == NULL) {
+        usageError(argv[0], "Missing the output file");
+    }
+    if (shape->data + shape->string + shape->macroCalls > 100) {
+        usageError(argv[0], "--data, --string and --macro-calls add up to "
+                            "more than 100%");
+    }
+    return output;
+}
+/******************************************************************************/
+/**
+ * Writes an operand of one of the given addressing modes. A label operand
+ * refers to an extern symbol with the extern ratio of the shape, and to a
+ * label of the program otherwise.
+ */
+void writeOperand(FILE *out, int modes, const Shape *shape) {
+    int choices[3], choicesSize = 0, mode;
+
+    if (labelsSize == 0 && externsSize == 0) {
+        modes &= ~MODE_DIRECT;
+    }
+    if (modes & MODE_IMMEDIATE) {
+        choices[choicesSize++] = MODE_IMMEDIATE;
+    }
+    if (modes & MODE_DIRECT) {
+        choices[choicesSize++] = MODE_DIRECT;
+    }
+    if (modes & MODE_REGISTER) {
+        choices[choicesSize++] = MODE_REGISTER;
+    }
+    mode = choices[randomBetween(0, choicesSize - 1)];
+
+    if (mode == MODE_IMMEDIATE) {
+        fprintf(out, "%ld", randomBetween(MIN_IMMEDIATE, MAX_IMMEDIATE));
+    } else if (mode == MODE_REGISTER) {
+        fprintf(out, "@r%ld", randomBetween(1, NUM_OF_REGISTERS));
+    } else if (labelsSize == 0 ||
+               (externsSize > 0 && randomChance(shape->externRatio))) {
+        fprintf(out, "X%ld", randomBetween(0, externsSize - 1));
+    } else {
+        fprintf(out, "L%ld", labelLines[randomBetween(0, labelsSize - 1)]);
+    }
+}
+/******************************************************************************/
+/**
+ * Writes a random command and its operands. The operands of a two operands
+ * command are both registers with the register pairs percentage of the
+ * shape, and at most one of them is a register otherwise, where the modes
+ * of the command allow it.
+ */
+void writeCommand(FILE *out, const Shape *shape) {
+    const Command *command = &commands[randomBetween(0, commandsSize - 1)];
+    int sourceModes = command->sourceModes;
+    int targetModes = command->targetModes;
+    int symbols = labelsSize > 0 || externsSize > 0;
+
+    /* lea takes only a label as its source */
+    if (!symbols && !(sourceModes & ~MODE_DIRECT) && sourceModes != 0) {
+        command = &commands[0];
+        sourceModes = command->sourceModes;
+        targetModes = command->targetModes;
+    }
+    fprintf(out, "%s", command->mnemonic);
+    if (targetModes == 0) {
+        return;
+    }
+    fputc(' ', out);
+    if (sourceModes != 0) {
+        if ((sourceModes & MODE_REGISTER) && (targetModes & MODE_REGISTER) &&
+            randomChance(shape->registerPairs)) {
+            fprintf(out, "@r%ld, @r%ld", randomBetween(1, NUM_OF_REGISTERS),
+                    randomBetween(1, NUM_OF_REGISTERS));
+            return;
+        }
+        /* Not a register pair: a register source takes another target */
+        if (sourceModes != MODE_REGISTER) {
+            sourceModes &= ~MODE_REGISTER;
+        }
+        writeOperand(out, sourceModes, shape);
+        fprintf(out, ", ");
+    }
+    writeOperand(out, targetModes, shape);
+}
+/******************************************************************************/
+/**
+ * Writes a .data directive of the data length of the shape, or of a few
+ * random numbers.
+ */
+void writeData(FILE *out, const Shape *shape) {
+    long i, count = shape->dataLength > 0 ? shape->dataLength
+                                          : randomBetween(1, MAX_DATA_NUMBERS);
+
+    fprintf(out, ".data ");
+    for (i = 0; i < count; i++) {
+        fprintf(out, "%s%ld", i > 0 ? ", " : "",
+                randomBetween(MIN_DATA_NUMBER, MAX_DATA_NUMBER));
+    }
+}
+/******************************************************************************/
+/**
+ * Writes a .string directive of a few random lowercase letters.
+ */
+void writeString(FILE *out) {
+    long i, length = randomBetween(1, MAX_STRING_LENGTH);
+
+    fprintf(out, ".string \"");
+    for (i = 0; i < length; i++) {
+        fputc((int) ('a' + randomBetween(0, 25)), out);
+    }
+    fputc('"', out);
+}
+/******************************************************************************/
+/**
+ * Writes the program: the .extern and .entry lines, the macro definitions,
+ * and then the statement lines.
+ */
+void writeProgram(FILE *out, const Shape *shape) {
+    LineKind *kinds;
+    char *labeled;
+    long i, j;
+    int kind;
+
+    kinds = malloc(sizeof(LineKind) * (shape->lines + 1));
+    labeled = malloc(shape->lines + 1);
+    labelLines = malloc(sizeof(long) * (shape->lines + 1));
+    if (kinds == NULL || labeled == NULL || labelLines == NULL) {
+        fprintf(stderr, "bench_gen: Error allocating memory\n");
+        exit(1);
+    }
+
+    /* The kinds and labels of the lines are chosen first, so that commands
+     * may refer to labels defined after them */
+    for (i = 0; i < shape->lines; i++) {
+        kind = (int) randomBetween(0, 99);
+        if (kind < shape->data) {
+            kinds[i] = LINE_DATA;
+        } else if (kind < shape->data + shape->string) {
+            kinds[i] = LINE_STRING;
+        } else if (shape->macros > 0 &&
+                   kind < shape->data + shape->string + shape->macroCalls) {
+            kinds[i] = LINE_MACRO_CALL;
+        } else {
+            kinds[i] = LINE_COMMAND;
+        }
+        /* A macro call can't define a label */
+        labeled[i] = kinds[i] != LINE_MACRO_CALL &&
+                     randomChance(shape->labelDensity);
+        if (labeled[i]) {
+            labelLines[labelsSize++] = i;
+        }
+    }
+
+    if (shape->externs >= 0) {
+        externsSize = shape->externs;
+    } else if (shape->externRatio > 0) {
+        externsSize = 1 + shape->lines / 50;
+    }
+    for (i = 0; i < externsSize; i++) {
+        fprintf(out, ".extern X%ld\n", i);
+    }
+    for (i = 0; i < labelsSize; i++) {
+        if (randomChance(shape->entryRatio)) {
+            fprintf(out, ".entry L%ld\n", labelLines[i]);
+        }
+    }
+
+    for (i = 0; i < shape->macros; i++) {
+        fprintf(out, "mcro m%ld\n", i);
+        for (j = 0; j < shape->expansion; j++) {
+            fputc(' ', out);
+            writeCommand(out, shape);
+            fputc('\n', out);
+        }
+        fprintf(out, "endmcro\n");
+    }
+
+    for (i = 0; i < shape->lines; i++) {
+        if (labeled[i]) {
+            fprintf(out, "L%ld: ", i);
+        }
+        switch (kinds[i]) {
+            case LINE_DATA:
+                writeData(out, shape);
+                break;
+            case LINE_STRING:
+                writeString(out);
+                break;
+            case LINE_MACRO_CALL:
+                fprintf(out, " m%ld", randomBetween(0, shape->macros - 1));
+                break;
+            default:
+                writeCommand(out, shape);
+        }
+        fputc('\n', out);
+    }
+
+    free(kinds);
+    free(labeled);
+    free(labelLines);
+}
+/******************************************************************************/
+int main(int argc, char *argv[]) {
+    Shape shape = {1, 1000, 20, 10, -1, 5, 0, 4, 10, 10, 0, 5, 20};
+    const char *output;
+    FILE *out;
+
+    output = parseArguments(argc, argv, &shape);
+    /* A xorshift generator must not start from 0 */
+    randomState = (shape.seed & 0xFFFFFFFFUL) != 0 ? shape.seed & 0xFFFFFFFFUL
+                                                   : 0x9E3779B9UL;
+
+    out = fopen(output, "w");
+    if (out == NULL) {
+        fprintf(stderr, "bench_gen: Couldn't create %s\n", output);
+        return 1;
+    }
+    writeProgram(out, &shape);
+    fclose(out);
+    return 0;
+}
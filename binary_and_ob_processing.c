@@ -5,13 +5,13 @@
 * Date:                 August-2023
 * Description:          This file includes a suite of functions designed for
 *                       processing lines of an assembler program, converting
-*                       various types of data to binary, handling base64
-*                       conversions, and writing these results into output files.
-*                       Functionality includes converting integers, command
-*                       numbers, parameter types, labels and strings to binary,
-*                       converting binary to decimal and base64, and processing
-*                       each line of input to validate and handle commands and
-*                       instructions accordingly.
+*                       various types of data to binary and writing the binary
+*                       object file. Functionality includes converting integers,
+*                       command numbers, parameter types, labels and strings to
+*                       words of the word image, and processing each line of
+*                       input to validate and handle commands and instructions
+*                       accordingly. The other output formats are written by
+*                       the output encoders.
 *
 \******************************************************************************/
 
@@ -19,462 +19,604 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 
 #include "param_validation.h"
 #include "print_error.h"
 #include "binary_and_ob_processing.h"
+#include "stats.h"
+
+/******************************** Definitions *********************************/
+/* The characters of a .string are widened to words four at a time inside an
+ * unsigned long (SIMD within a register) where it holds the four 16-bit
+ * words of an unsigned int of four characters */
+#if ULONG_MAX > 0xFFFFFFFFUL && UINT_MAX == 0xFFFFFFFFU && USHRT_MAX == 0xFFFF
+#define WIDEN_STRING_CHARACTERS
+#endif
+
+/****************************** Type  Definitions *****************************/
+/* Validates the operands of a command and decodes them into its statement */
+typedef Status (*CommandDecoder)(Statement *statement, char **operands,
+                                 ProgramState *programState);
+
+/* Adds the words of a decoded command of one shape to the code image */
+typedef void (*CommandEncoder)(const Statement *statement,
+                               ProgramState *programState);
+
+/**************************** Forward Declarations ****************************/
+Status decodeNoOperands(Statement *statement, char **operands,
+                        ProgramState *programState);
+
+Status decodeOneOperand(Statement *statement, char **operands,
+                        ProgramState *programState);
+
+Status decodeTwoOperands(Statement *statement, char **operands,
+                         ProgramState *programState);
+
+void encodeNoOperands(const Statement *statement, ProgramState *programState);
+
+void encodeOneOperand(const Statement *statement, ProgramState *programState);
+
+void encodeRegisterPair(const Statement *statement,
+                        ProgramState *programState);
+
+void encodeTwoOperands(const Statement *statement, ProgramState *programState);
+
+#ifdef WIDEN_STRING_CHARACTERS
+unsigned long widenCharacters(unsigned int characters);
+#endif
+
+/******************* Global variable definitions ******************************/
+/* The decoder of each command shape, indexed by the paramCount of the command.
+ * A single operand is always the target operand, and the operand types of each
+ * command are taken from operandTypes by the decoder. */
+static const CommandDecoder commandDecoders[] = {
+        decodeNoOperands,  /* rts, stop */
+        decodeOneOperand,  /* not, clr, inc, dec, jmp, bne, red, prn, jsr */
+        decodeTwoOperands  /* mov, cmp, add, sub, lea */
+};
+
+/* The encoder of each command shape, indexed by the CommandShape the decoder
+ * recorded in the statement */
+static const CommandEncoder commandEncoders[] = {
+        encodeNoOperands,   /* COMMAND_SHAPE_NO_OPERANDS */
+        encodeOneOperand,   /* COMMAND_SHAPE_ONE_OPERAND */
+        encodeRegisterPair, /* COMMAND_SHAPE_REGISTER_PAIR */
+        encodeTwoOperands   /* COMMAND_SHAPE_TWO_OPERANDS */
+};
 
 /************************* Functions  Implementations *************************/
 /**
-* This function prints the binary representation of a given integer value
-* @param value - The integer value to print its binary representation
-* @param numBits - The number of bits to represent the integer in binary form
-* @param outputFile - The file to print the binary representation
-*/
-void printBinary(int value, int numBits, FILE *outputFile) {
-    int i;
-    for (i = numBits - 1; i >= 0; i--) {
-        int mask = 1 << i;
-        int bit = (value & mask) ? 1 : 0;
-        fprintf(outputFile, "%d", bit);
-    }
-}
-/******************************************************************************/
-/**
-* This function prints the binary representation of a given command along with its parameters
-* @param commandNum - The command number
+* This function adds the word of a given command along with the addressing modes of its parameters
+* @param commandIdx - The index of the command in the commands list
 * @param firstParamType - The type of the first parameter
 * @param secondParamType - The type of the second parameter
-* @param outputFile - The file to print the binary representation
+* @param image - The word image to add the word to
 */
-void printBinaryCommand(int commandNum, int firstParamType, int secondParamType,
-                        FILE *outputFile) {
-    /* Print the last 3 bits for the first parameter type */
-    printBinary(firstParamType, 3, outputFile);
-
-    /* Print the next 4 bits for the command number */
-    printBinary(commandNum, 4, outputFile);
-
-    /* Print the next 3 bits for the second parameter type */
-    printBinary(secondParamType, 3, outputFile);
-
-    /* Print the first 2 bits as "00" */
-    fprintf(outputFile, "00");
-
-    fprintf(outputFile, "\n");
+void addBinaryCommand(int commandIdx, int firstParamType, int secondParamType,
+                      WordImage *image) {
+    /* The opcode and ARE bits come from the command's template, the
+     * addressing modes of the parameters are added to it */
+    push_word(image, commandTemplates[commandIdx] |
+                     ((firstParamType & ISA_SOURCE_MASK) << ISA_SOURCE_SHIFT) |
+                     ((secondParamType & ISA_TARGET_MASK) << ISA_TARGET_SHIFT));
 }
 /******************************************************************************/
 /**
-* This function prints the binary representation of a given integer parameter
-* @param number - The integer parameter to print its binary representation
-* @param outputFile - The file to print the binary representation
+* This function adds the word of a given integer parameter
+* @param number - The integer parameter, negative numbers are in two's complement
+* @param image - The word image to add the word to
 */
-void printBinaryPrameterInteger(int number, FILE *outputFile) {
-    /* Check if the number is negative*/
-    if (number < 0) {
-        /* Convert the negative number to its two's complement representation*/
-        number = (1 << 10) + number;
-    }
-    /* Print the next 10 bits for the type of the integer*/
-    printBinary(number, 10, outputFile);
-
-    /* Print the first 2 bits as "00"*/
-    fprintf(outputFile, "00");
-    fprintf(outputFile, "\n");
+void addBinaryPrameterInteger(int number, WordImage *image) {
+    /* The integer in the value field and absolute ARE bits */
+    push_word(image, (number & ISA_VALUE_MASK) << ISA_VALUE_SHIFT);
 }
 /******************************************************************************/
 /**
-* This function prints the binary representation of given source and target operands
+* This function adds the word of given source and target register operands
 * @param sourceOperand - The source operand
 * @param targetOperand - The target operand
-* @param outputFile - The file to print the binary representation
+* @param image - The word image to add the word to
 */
-void printBinaryPrameterRegister(int sourceOperand, int targetOperand,
-                                 FILE *outputFile) {
-    /*Print the next 5 bits for the source operand*/
-    printBinary(sourceOperand, 5, outputFile);
-
-    /*Print the next 5 bits for the target operand*/
-    printBinary(targetOperand, 5, outputFile);
-
-    /* Print the first 2 bits as "00"*/
-    fprintf(outputFile, "00");
-
-    fprintf(outputFile, "\n");
+void addBinaryPrameterRegister(int sourceOperand, int targetOperand,
+                               WordImage *image) {
+    /* The source and target register fields and absolute ARE bits */
+    push_word(image, ((sourceOperand & ISA_SOURCE_REGISTER_MASK) <<
+                      ISA_SOURCE_REGISTER_SHIFT) |
+                     ((targetOperand & ISA_TARGET_REGISTER_MASK) <<
+                      ISA_TARGET_REGISTER_SHIFT));
 }
 /******************************************************************************/
 /**
-* This function prints the binary representation of a given label entry
-* @param labelCode - The label code
-* @param outputFile - The file to print the binary representation
+* This function adds the word of a label operand. The word is patched by
+* ResolveFixups once all the labels are known, so a fixup is recorded for it.
+* @param labelName - The label
+* @param statement - The statement referring to the label, for error messages
+* @param image - The word image to add the word to
+* @param fixups - The fixups of the program
+* @param arena - The arena to allocate the fixup from
 */
-void printBinaryrPameterLabelEntry(int labelCode, FILE *outputFile) {
-
-    /*Print the next 10 bits for the label code*/
-    printBinary(labelCode, 10, outputFile);
-
-    /*Print the first 2 bits as "10"*/
-    fprintf(outputFile, "10");
-
-    fprintf(outputFile, "\n");
-
+void addBinaryPrameterLabel(const char *labelName, const Statement *statement,
+                            WordImage *image, Vector *fixups, Arena *arena) {
+    push_back(fixups, new_fixup(arena, labelName, push_word(image, 0),
+                                statement->line_number,
+                                statement->source->origin_file,
+                                statement->source->origin_line));
 }
 /******************************************************************************/
+#ifdef WIDEN_STRING_CHARACTERS
 /**
-* This function prints the binary representation of a given label extern
-* @param outputFile - The file to print the binary representation
+* This function widens four characters to four words, in the same order in
+* the register whatever the byte order of the machine
+* @param characters - The four characters, loaded into an unsigned int
+* @return The four words, to be stored as they are
 */
-void printBinaryrPameterLabelExtern(FILE *outputFile) {
-    /*Print the first 10 bits as "0"*/
-    fprintf(outputFile, "0000000000");
-
-    /*Print the first 2 bits as "01"*/
-    fprintf(outputFile, "01");
-
-    fprintf(outputFile, "\n");
+unsigned long widenCharacters(unsigned int characters) {
+    unsigned long words = characters;
+    words = (words | (words << 16)) & 0x0000FFFF0000FFFFUL;
+    return (words | (words << 8)) & 0x00FF00FF00FF00FFUL;
 }
+#endif
 /******************************************************************************/
 /**
-* This function prints the binary representation of a given string
-* @param str - The string to print its binary representation
-* @param outputFile - The file to print the binary representation
+* This function adds the words of a given string, one for each character
+* except the ' characters, and of its terminating '\0'.
+* The image is grown once for the whole string, and a string without '
+* characters is widened to words four characters at a time, until a character
+* outside of ASCII, which keeps its sign extension in the scalar loop.
+* @param str - The string
+* @param image - The word image to add the words to
 */
-void printBinaryString(const char *str, FILE *outputFile) {
-    int i = 0;
-    int j = 0;
-    while (str[i] != '\0') {
-        if (str[i] != '\'') {
-            printBinary((int) str[i], 12, outputFile);
-            fprintf(outputFile, "\n");
+void addBinaryString(const char *str, WordImage *image) {
+    int i = 0, length = (int) strlen(str), count = 0;
+    unsigned short *words = append_words(image, length + 1);
+#ifdef WIDEN_STRING_CHARACTERS
+    unsigned int characters;
+    unsigned long widened;
+#endif
+
+    if (memchr(str, '\'', length) == NULL) {
+#ifdef WIDEN_STRING_CHARACTERS
+        for (; i + 4 <= length; i += 4) {
+            memcpy(&characters, str + i, 4);
+            if (characters & 0x80808080U) {
+                break;
+            }
+            widened = widenCharacters(characters);
+            memcpy(words + i, &widened, 8);
+        }
+#endif
+        for (; i < length; i++) {
+            words[i] = (unsigned short) (str[i] & WORD_MASK);
+        }
+        count = length;
+    } else {
+        for (i = 0; i < length; i++) {
+            if (str[i] != '\'') {
+                words[count++] = (unsigned short) (str[i] & WORD_MASK);
+            }
         }
-        i++;
+        /* Give back the words of the skipped characters */
+        image->size -= length - count;
     }
 
-    /*Print 12 zeros*/
-    for (j = 0; j < 12; j++) {
-        fprintf(outputFile, "0");
-    }
-    fprintf(outputFile, "\n");
+    /* The terminating '\0' */
+    words[count] = 0;
 }
 /******************************************************************************/
 /**
-* This function prints the binary representation of a given integer data parameter
-* @param number - The data parameter to print its binary representation
-* @param outputFile - The file to print the binary representation
+* This function adds the words of a list of integer data parameters, converted
+* and masked to 12 bits into the image by a single loop
+* @param numbers - The data parameters, negative numbers are in two's complement
+* @param count - The number of data parameters
+* @param image - The word image to add the words to
 */
-void printBinaryDataPrameter(int number, FILE *outputFile) {
-    /* Check if the number is negative*/
-    if (number < 0) {
-        /* Convert the negative number to its two's complement representation*/
-        number = (1 << 12) + number;
+void addBinaryDataPrameters(char **numbers, int count, WordImage *image) {
+    int i;
+    unsigned short *words = append_words(image, count);
+    for (i = 0; i < count; i++) {
+        words[i] = (unsigned short) (atoi(numbers[i]) & WORD_MASK);
     }
-    /* Print the next 10 bits for the type of the integer*/
-    printBinary(number, 12, outputFile);
-    fprintf(outputFile, "\n");
 }
 /******************************************************************************/
 /**
-* This function converts a binary number to its equivalent decimal form
-* @param binary - The binary number to convert
-* @return The equivalent decimal of the binary number
+* This function writes an unsigned integer in little-endian byte order
+* @param value - The integer to write
+* @param numBytes - The number of bytes to write
+* @param outputFile - The output file
 */
-int binaryToDecimal(char *binary) {
-    int decimal = 0;
-    int len = strlen(binary);
-    int i = 0;
-    for (i = 0; i < len; i++) {
-        if (binary[i] == '1')
-            decimal += 1 << (len - i - 1);
+void writeLittleEndian(unsigned long value, int numBytes, FILE *outputFile) {
+    int i;
+    for (i = 0; i < numBytes; i++) {
+        fputc((int) ((value >> (8 * i)) & 0xFF), outputFile);
     }
-
-    return decimal;
 }
 /******************************************************************************/
 /**
-*  This function converts a decimal number to its equivalent base64 character
-* @param decimal - The decimal number to convert
-* @return The equivalent base64 character of the decimal number
+* This function writes a symbol record of the binary object file
+* @param name - The name of the symbol
+* @param address - The address of the symbol
+* @param outputFile - The output file
 */
-char decimalToBase64(int decimal) {
-    if (decimal < 26)
-        return 'A' + decimal;
-    else if (decimal < 52)
-        return 'a' + (decimal - 26);
-    else if (decimal < 62)
-        return '0' + (decimal - 52);
-    else if (decimal == 62)
-        return '+';
-    else
-        return '/';
+void writeObjectSymbol(const char *name, int address, FILE *outputFile) {
+    char paddedName[MAX_LABEL_LENGTH] = {0};
+    strncpy(paddedName, name, MAX_LABEL_LENGTH - 1);
+    fwrite(paddedName, 1, MAX_LABEL_LENGTH, outputFile);
+    writeLittleEndian((unsigned long) address, 4, outputFile);
 }
 /******************************************************************************/
 /**
-*   This function reads a binary file and writes its equivalent base64 form to an output file
-* @param input_file - The input file in binary form
-* @param output_file - The output file to write the equivalent base64 form
-* @param IC - Instruction counter
-* @param DC - Data counter
+* This function writes the words of the program to a binary object file,
+* the code followed by the data, packed two 12-bit words in every 3 bytes
+* @param code - The instruction words of the program
+* @param data - The data words of the program
+* @param outputFile - The output file
+* @return The number of bytes written
 */
-void binaryToBase64(const char *input_file, const char *output_file, int IC,
-                    int DC) {
-    FILE *inputFile = NULL, *outputFile = NULL;
-    char buffer[13];  /* Buffer to store binary digits (12 + '\0') */
-    char word1[7];
-    char word2[7];
-    int decimal1 = -1, decimal2 = -1;
-    char base64_1 = -1, base64_2 = -1;
-
-    inputFile = fopen(input_file, "r");
-    if (NULL == inputFile) {
-        printf("Failed to open the file.\n");
-        exit(1);
+long writePackedWords(const WordImage *code, const WordImage *data,
+                      FILE *outputFile) {
+    int i, total = code->size + data->size;
+    unsigned int first, second;
+    long written = 0;
+
+    for (i = 0; i < total; i += 2) {
+        first = i < code->size ? code->words[i] : data->words[i - code->size];
+        second = 0;
+        if (i + 1 < total) {
+            second = i + 1 < code->size ? code->words[i + 1]
+                                        : data->words[i + 1 - code->size];
+        }
+        fputc((int) (first >> 4), outputFile);
+        fputc((int) (((first & 0xF) << 4) | (second >> 8)), outputFile);
+        fputc((int) (second & 0xFF), outputFile);
+        written += 3;
+    }
+    return written;
+}
+/******************************************************************************/
+/**
+ * Writes the words of the program, its symbol table and its relocation table
+ * to a binary object file. The counts in the header are those of the records
+ * actually written, so readers can rely on them for the layout.
+ *
+ * @param output_file - The path of the binary object file.
+ * @param programState - The state of the program, after its label
+ *                       references were resolved.
+ */
+void writeBinaryObject(const char *output_file, ProgramState *programState) {
+    FILE *outputFile = NULL;
+    Label *label = NULL;
+    Fixup *fixup = NULL;
+    int *symbolIndexes = NULL; /* The symbol of each extern label */
+    int i, numOfEntries = 0, numOfExterns = 0, numOfRelocations = 0;
+    long written = 0;
+
+    symbolIndexes = arena_alloc(programState->arena,
+                                sizeof(int) * (programState->labels.size + 1));
+
+    /* The entry symbols are followed by the extern symbols */
+    for (i = 0; i < programState->labels.size; i++) {
+        label = &programState->labels.items[i];
+        numOfEntries += label->isEntry ? 1 : 0;
     }
-    outputFile = fopen(output_file, "w");
+    for (i = 0; i < programState->labels.size; i++) {
+        label = &programState->labels.items[i];
+        symbolIndexes[i] = label->isExtern ? numOfEntries + numOfExterns++ : -1;
+    }
+    for (i = 0; i < programState->fixups->size; i++) {
+        fixup = (Fixup *) programState->fixups->items[i];
+        numOfRelocations += fixup->slot != -1 ? 1 : 0;
+    }
+
+    outputFile = fopen(output_file, "wb");
     if (NULL == outputFile) {
         printf("Failed to open the file.\n");
         exit(1);
     }
-/*input_file*/
-    /* Read the file line by line */
-    fprintf(outputFile, "%d %d\n", IC, DC);
-    while (fgets(buffer, sizeof(buffer), inputFile)) {
-
-        if (buffer[0] == '\n')
-            continue;
-        strncpy(word1, buffer, 6);
-        word1[6] = '\0';
-
-        strncpy(word2, buffer + 6, 6);
-        word2[6] = '\0';
-
-        /* Convert each word to decimal */
-        decimal1 = binaryToDecimal(word1);
-        decimal2 = binaryToDecimal(word2);
-
-        /* Convert each decimal to base64 character */
-        base64_1 = decimalToBase64(decimal1);
-        base64_2 = decimalToBase64(decimal2);
-
-        /* Write the base64 characters to the output file */
-        fputc(base64_1, outputFile);
-        fputc(base64_2, outputFile);
-        fputc('\n', outputFile);
+
+    /* The header */
+    fwrite(OBJECT_MAGIC, 1, 4, outputFile);
+    writeLittleEndian(OBJECT_VERSION, 2, outputFile);
+    writeLittleEndian(OBJECT_HEADER_SIZE, 2, outputFile);
+    writeLittleEndian((unsigned long) programState->code->size, 4, outputFile);
+    writeLittleEndian((unsigned long) programState->data->size, 4, outputFile);
+    writeLittleEndian((unsigned long) numOfEntries, 4, outputFile);
+    writeLittleEndian((unsigned long) numOfExterns, 4, outputFile);
+    writeLittleEndian((unsigned long) numOfRelocations, 4, outputFile);
+    writeLittleEndian(START_ADDRESS, 4, outputFile);
+
+    /* The words, padded to a multiple of 4 bytes */
+    written = writePackedWords(programState->code, programState->data,
+                               outputFile);
+    for (; written % 4 != 0; written++) {
+        fputc(0, outputFile);
+    }
+
+    /* The symbol table */
+    for (i = 0; i < programState->labels.size; i++) {
+        label = &programState->labels.items[i];
+        if (label->isEntry) {
+            writeObjectSymbol(label->name, label->asm_line_number, outputFile);
+        }
+    }
+    for (i = 0; i < programState->labels.size; i++) {
+        label = &programState->labels.items[i];
+        if (label->isExtern) {
+            writeObjectSymbol(label->name, 0, outputFile);
+        }
+    }
+
+    /* The relocation table, the fixups of the words are in increasing order */
+    for (i = 0; i < programState->fixups->size; i++) {
+        fixup = (Fixup *) programState->fixups->items[i];
+        if (fixup->slot == -1) {
+            continue; /* An '.entry' directive */
+        }
+        label = &programState->labels.items[fixup->label_index];
+        writeLittleEndian((unsigned long) fixup->slot, 4, outputFile);
+        if (label->isExtern) {
+            writeLittleEndian(RELOCATION_SYMBOL, 2, outputFile);
+            writeLittleEndian((unsigned long) symbolIndexes[fixup->label_index],
+                              2, outputFile);
+        } else {
+            writeLittleEndian(RELOCATION_BASE, 2, outputFile);
+            writeLittleEndian(0, 2, outputFile);
+        }
     }
 
-    /* Close the files */
-    fclose(inputFile);
+    STATS_ADD(STAT_BYTES_WRITTEN, ftell(outputFile));
     fclose(outputFile);
 }
 /******************************************************************************/
 /**
- * Processes a line of assembly code by parsing the command or instruction
- * and its parameters, validating their correctness, and then writing them
- * to binary code. It also manages the program state by updating instruction
- * and data counters and handling labels. Errors in the assembly code are
- * reported through appropriate error messages.
+ * Validates an operand against the addressing modes a command allows for it.
+ *
+ * @param statement - The statement of the command, for error messages.
+ * @param operand - The operand to validate.
+ * @param expectedType - The addressing modes the command allows for it.
+ * @param programState - The current state of the program.
+ *
+ * @return The addressing mode of the operand, or -1 if it isn't allowed.
+ */
+int validateOperand(const Statement *statement, char *operand,
+                    OperandType expectedType, ProgramState *programState) {
+    const TokenizedLine *line = statement->source;
+    if (!isValidParam(operand, expectedType, programState)) {
+        PrintCommandInstructionErrorMessage(statement->line_number,
+                                            INVALID_PARAM_FOR_COMMAND,
+                                            line->words[line->has_label],
+                                            operand);
+        return -1;
+    }
+    return findParameterType(operand, programState);
+}
+/******************************************************************************/
+/**
+ * Decodes an operand by its addressing mode: the value of an immediate
+ * number, the number of a register or the name of a label.
+ *
+ * @param operand - The operand.
+ * @param mode - The addressing mode of the operand.
+ * @param decoded - The operand of the statement to fill.
+ */
+void decodeOperand(char *operand, int mode, StatementOperand *decoded) {
+    decoded->mode = (signed char) mode;
+    if (mode == NUMBER) {
+        decoded->value.number = atoi(operand);
+    } else if (mode == REGISTER) {
+        decoded->value.reg = findRegister(operand);
+    } else if (mode == LABEL) {
+        decoded->value.symbol = operand;
+    }
+}
+/******************************************************************************/
+/**
+ * Decodes a command without operands: only the command word.
+ *
+ * @param statement - The statement of the command.
+ * @param operands - The operands of the command (none).
+ * @param programState - The current state of the program.
+ *
+ * @return SUCCESS.
+ */
+Status decodeNoOperands(Statement *statement, char **operands,
+                        ProgramState *programState) {
+    statement->shape = COMMAND_SHAPE_NO_OPERANDS;
+    statement->num_of_words = commandWordCount[statement->opcode];
+    return SUCCESS;
+}
+/******************************************************************************/
+/**
+ * Decodes a command with a single operand, which is always the target operand.
+ *
+ * @param statement - The statement of the command.
+ * @param operands - The target operand.
+ * @param programState - The current state of the program.
+ *
+ * @return SUCCESS if the operand is valid, FAILURE otherwise.
+ */
+Status decodeOneOperand(Statement *statement, char **operands,
+                        ProgramState *programState) {
+    int targetType = validateOperand(statement, operands[0],
+                                     operandTypes[statement->opcode][1],
+                                     programState);
+    if (targetType == -1) {
+        return FAILURE;
+    }
+
+    decodeOperand(operands[0], targetType, &statement->operands[1]);
+    statement->shape = COMMAND_SHAPE_ONE_OPERAND;
+    statement->num_of_words = commandWordCount[statement->opcode];
+    return SUCCESS;
+}
+/******************************************************************************/
+/**
+ * Decodes a command with a source and a target operand.
+ * Two register operands share a single extra word, one less than the words
+ * of the command in the ISA tables, and are encoded as a register pair.
+ *
+ * @param statement - The statement of the command.
+ * @param operands - The source and target operands.
+ * @param programState - The current state of the program.
+ *
+ * @return SUCCESS if the operands are valid, FAILURE otherwise.
+ */
+Status decodeTwoOperands(Statement *statement, char **operands,
+                         ProgramState *programState) {
+    int targetType = -1;
+    int sourceType = validateOperand(statement, operands[0],
+                                     operandTypes[statement->opcode][0],
+                                     programState);
+    if (sourceType == -1) {
+        return FAILURE;
+    }
+    targetType = validateOperand(statement, operands[1],
+                                 operandTypes[statement->opcode][1],
+                                 programState);
+    if (targetType == -1) {
+        return FAILURE;
+    }
+
+    decodeOperand(operands[0], sourceType, &statement->operands[0]);
+    decodeOperand(operands[1], targetType, &statement->operands[1]);
+    if (sourceType == REGISTER && targetType == REGISTER) {
+        statement->shape = COMMAND_SHAPE_REGISTER_PAIR;
+        statement->num_of_words = commandWordCount[statement->opcode] - 1;
+    } else {
+        statement->shape = COMMAND_SHAPE_TWO_OPERANDS;
+        statement->num_of_words = commandWordCount[statement->opcode];
+    }
+    return SUCCESS;
+}
+/******************************************************************************/
+/**
+ * Returns the number of words of a '.string' directive: one for each
+ * character except the ' characters, and one for its terminating '\0'.
+ *
+ * @param str - The string.
+ *
+ * @return The number of words.
+ */
+int stringWordCount(const char *str) {
+    int count = 1;
+    for (; *str != '\0'; str++) {
+        count += *str != '\'';
+    }
+    return count;
+}
+/******************************************************************************/
+/**
+ * Decodes a line of assembly code into a statement by parsing the command or
+ * instruction and its parameters and validating their correctness. The
+ * statement holds everything needed to size and encode the line, so the
+ * words of the line are not parsed again. '.entry' and '.extern' directives
+ * mark their labels here. Errors in the assembly code are reported through
+ * appropriate error messages, and leave the statement without words.
  *
- * @param line - A pointer to the Line structure representing the current
- *               assembly line being processed.
- * @param bin_fp - A pointer to the binary output file.
+ * @param line - The tokenized line.
+ * @param line_number - The line number in the .am file.
+ * @param statement - The statement to fill.
  * @param programState - A pointer to the ProgramState structure
  *                       representing the current state of the program.
  *
- * @return Status - SUCCESS if the line is processed successfully; FAILURE if any
- *                  error is encountered during the processing.
+ * @return Status - SUCCESS if the line is decoded successfully; FAILURE if any
+ *                  error is encountered during the decoding.
  */
-Status ProcessLine(Line *line, FILE *bin_fp, ProgramState *programState) {
+Status DecodeLine(const TokenizedLine *line, int line_number,
+                  Statement *statement, ProgramState *programState) {
     /* Command and instruction indices - used to identify the type of line (command or instruction) */
-    char *command = line->input_words[line->has_label];
-    int commandIdx = findCommand(command);
-    int instructionIdx = findInstruction(command);
+    char *command = NULL;
+    int commandIdx = -1;
+    int instructionIdx = -1;
+    char *parameter = NULL;
 
     /* Current program state and label information */
     ProgramState *currentProgramState = programState;
     Label *label = NULL;
-    int labelIdx = -1;
-
-    /* Parameter processing variables */
-    int expectedParamCount = -1;  /* The expected count of parameters for the current command */
-    char *paramWords[2] = {0};  /* The parameters' words */
-    int paramTypes[2] = {0};  /* The types of parameters */
-    int paramIndex = 0;  /* Used to track the current parameter index */
-    int operandTypeIndex = 0;  /* Used to track the current operand type index */
-    int paramType = -1;  /* Type of current parameter */
-
-    /* Register processing variables */
-    int first_register_id = -1;
-    int second_register_id = -1;
-
-    /* Loop counter */
-    int i;
+    Status ret = SUCCESS;
+
+    statement->source = line;
+    statement->line_number = line_number;
+    statement->num_of_words = 0;
+    statement->kind = STATEMENT_NONE;
+    statement->opcode = -1;
+    statement->shape = COMMAND_SHAPE_NO_OPERANDS;
+    statement->operands[0].mode = OPERAND_TYPE_NONE;
+    statement->operands[1].mode = OPERAND_TYPE_NONE;
+
+    /* A label alone on its line labels no command */
+    if (line->num_of_words <= line->has_label) {
+        PrintCommandInstructionErrorMessage(line_number,
+                                            NOT_VALID_COMMAND_OR_INSTRUCTION,
+                                            "", NULL);
+        return FAILURE;
+    }
+    command = line->words[line->has_label];
+    commandIdx = findCommand(command);
+    instructionIdx = findInstruction(command);
 
     /* Process a command if found */
     if (commandIdx != -1) {
-        /* Increment instruction counter for commands */
-        currentProgramState->IC++;
         /* Validate the number of parameters against the expected count for the command */
-        expectedParamCount = paramCount[commandIdx];
-        if (line->num_of_words - 1 - line->has_label != expectedParamCount) {
-            PrintCommandInstructionErrorMessage(line->line_number,
+        if (line->num_of_words - 1 - line->has_label !=
+            paramCount[commandIdx]) {
+            PrintCommandInstructionErrorMessage(line_number,
                                                 INCORRECT_NUM_OF_PARAMS_FOR_COMMAND,
                                                 command, NULL);
             return FAILURE;
         }
-        /* Go through each parameter to check its validity */
-        for (i = 1 + line->has_label; i < line->num_of_words; i++) {
-            OperandType expectedType = operandTypes[commandIdx][operandTypeIndex];
-            while (expectedType == OPERAND_TYPE_NONE &&
-                   operandTypeIndex < 2) {
-                if (paramIndex >= 2) {
-                    PrintCommandInstructionErrorMessage(line->line_number,
-                                                        TOO_MANY_PARAMS_FOR_COMMAND,
-                                                        command, NULL);
-                    return FAILURE;
-                }
-                paramTypes[paramIndex++] = OPERAND_TYPE_NONE;
-                expectedType = operandTypes[commandIdx][++operandTypeIndex];
-            }
-            if (expectedType == OPERAND_TYPE_NONE) {
-                PrintCommandInstructionErrorMessage(line->line_number,
-                                                    TOO_MANY_PARAMS_FOR_COMMAND,
-                                                    command, NULL);
-                return FAILURE;
-            }
-            if (!isValidParam(line->input_words[i], expectedType,
-                              currentProgramState)) {
-                PrintCommandInstructionErrorMessage(line->line_number,
-                                                    INVALID_PARAM_FOR_COMMAND,
-                                                    command,
-                                                    line->input_words[i]);
-                return FAILURE;
-            }
-            if (paramIndex >= 2) {
-                PrintCommandInstructionErrorMessage(line->line_number,
-                                                    TOO_MANY_PARAMS_FOR_COMMAND,
-                                                    command, NULL);
-                return FAILURE;
-            }
-            paramTypes[paramIndex] = findParameterType(line->input_words[i],
-                                                       currentProgramState);
-            paramWords[paramIndex] = line->input_words[i];
-            paramIndex++;
-            operandTypeIndex++;
-        }
-
-        /* print the binary command */
-        printBinaryCommand(commandIdx, paramTypes[0], paramTypes[1], bin_fp);
-
-        /* Process and print the parameters... */
-        for (i = 0; i < 2; i++) {
-            paramType = paramTypes[i];
-            /*printf("The param %s is a %d!\n", paramWords[i], paramTypes[i]);*/
-            switch (paramType) {
-                case NUMBER:
-                    currentProgramState->IC++;
-                    printBinaryPrameterInteger(atoi(paramWords[i]), bin_fp);
-                    break;
-                case REGISTER:
-                    /* When the command has an implicit first parameter (only one operand),
-                       we treat the register as the second operand (target operand. */
-                    if (paramCount[commandIdx] == 1 && i == 0) {
-                        sscanf(paramWords[i], "%*[^0-9]%d",
-                               &second_register_id);
-                        currentProgramState->IC++;
-                        /* If the current and next parameter are both registers, we parse both registers. */
-                    } else if (i == 0 && paramTypes[i + 1] == REGISTER) {
-                        sscanf(paramWords[i], "%*[^0-9]%d", &first_register_id);
-                        sscanf(paramWords[i + 1], "%*[^0-9]%d",
-                               &second_register_id);
-                        currentProgramState->IC++;
-                        /* If the previous parameter is not a register, we parse the current register as the second operand. */
-                    } else if (i == 0 && paramTypes[i + 1] != REGISTER) {
-                        sscanf(paramWords[i], "%*[^0-9]%d",
-                               &first_register_id);
-                        currentProgramState->IC++;
-                    } else if (i == 1 && paramTypes[i - 1] != REGISTER) {
-                        sscanf(paramWords[i], "%*[^0-9]%d",
-                               &second_register_id);
-                        currentProgramState->IC++;
-                    }
-                    break;
-
-                case LABEL:
-                    currentProgramState->IC++;
-                    if (isLabel(paramWords[i], currentProgramState)) {
-                        labelIdx = getLabelIndex(paramWords[i],
-                                                 currentProgramState);
-                        label = (Label *) programState->labels->items[labelIdx];
-                        if (label->isExtern) {
-                            printBinaryrPameterLabelExtern(bin_fp);
-                        } else {
-                            printBinaryrPameterLabelEntry(
-                                    label->asm_line_number,
-                                    bin_fp);
-                        }
-                    } else {
-                        PrintLabelErrorMessage(line->line_number,
-                                               LABEL_DOES_NOT_EXIST,
-                                               paramWords[1]);
-                    }
-                    break;
-            }
-            if (first_register_id != -1 || second_register_id != -1) {
-                /* If either first_register_id or second_register_id is not -1 (default),
-                   we print the binary parameters. If one of them is -1 (default),
-                   we substitute it with 0 for the function call. */
-                printBinaryPrameterRegister(
-                        first_register_id == -1 ? 0 : first_register_id,
-                        second_register_id == -1 ? 0 : second_register_id,
-                        bin_fp);
-                /* We reset the first_register_id and second_register_id to -1
-                   for the next iteration. */
-                first_register_id = -1;
-                second_register_id = -1;
-            }
+        /* Validate and decode the operands with the decoder of the command's shape */
+        statement->opcode = (signed char) commandIdx;
+        ret = commandDecoders[paramCount[commandIdx]](statement,
+                                                      line->words + 1 +
+                                                      line->has_label,
+                                                      currentProgramState);
+        if (ret == SUCCESS) {
+            statement->kind = STATEMENT_COMMAND;
         }
+        return ret;
         /* Process an instruction if found */
     } else if (instructionIdx != -1) {
+        statement->opcode = (signed char) instructionIdx;
+        parameter = line->words[line->has_label + 1];
         /* Handle 'ENTRY' and 'EXTERN' instructions */
         if (instructionIdx == ENTRY_INSTRUCTION ||
             instructionIdx == EXTERN_INSTRUCTION) {
             /* For entry and extern, there should only be one parameter */
             if (line->num_of_words - 1 - line->has_label != 1) {
-                PrintCommandInstructionErrorMessage(line->line_number,
+                PrintCommandInstructionErrorMessage(line_number,
                                                     INCORRECT_NUM_OF_PARAMS_FOR_INSTRUCTION,
                                                     command, NULL);
                 return FAILURE;
             }
+            /* In one pass, the label may be defined later, it is checked by ResolveFixups */
+            if (instructionIdx == ENTRY_INSTRUCTION &&
+                currentProgramState->onePass) {
+                statement->kind = STATEMENT_ENTRY;
+                statement->operands[0].value.symbol = parameter;
             /* For entry, the label must exist */
-            if (instructionIdx == ENTRY_INSTRUCTION) {
-                if (!isLabelExists(line->input_words[1 + line->has_label],
-                                   currentProgramState)) {
-                    PrintLabelErrorMessage(line->line_number,
+            } else if (instructionIdx == ENTRY_INSTRUCTION) {
+                if (!isLabelExists(parameter, currentProgramState)) {
+                    PrintLabelErrorMessage(line_number,
                                            ENTRY_REQUIRES_EXISTING_LABEL,
-                                           line->input_words[1 +
-                                                             line->has_label]);
+                                           parameter);
                     return FAILURE;
                 } else {
                     /* Mark the label as an entry */
-                    label = (Label *) programState->labels->items[getLabelIndex(
-                            line->input_words[line->has_label +
-                                              1],
-                            currentProgramState)];
+                    label = &programState->labels.items[getLabelIndex(
+                            parameter, currentProgramState)];
                     label->isEntry = 1;
                 }
             } else if (instructionIdx == EXTERN_INSTRUCTION) {
-                if (isLabelExists(line->input_words[1 + line->has_label],
-                                  currentProgramState)) {
-                    PrintLabelErrorMessage(line->line_number,
+                if (isLabelExists(parameter, currentProgramState)) {
+                    PrintLabelErrorMessage(line_number,
                                            EXTERN_REQUIRES_NONEXISTING_LABEL,
-                                           line->input_words[1 +
-                                                             line->has_label]);
+                                           parameter);
                     return FAILURE;
                 } else {
                     /* Mark the label as an entry */
-                    label = (Label *) programState->labels->items[getLabelIndex(
-                            line->input_words[line->has_label +
-                                              1],
-                            currentProgramState)];
+                    label = &programState->labels.items[getLabelIndex(
+                            parameter, currentProgramState)];
                     label->isExtern = 1;
                 }
             }
@@ -483,36 +625,149 @@ Status ProcessLine(Line *line, FILE *bin_fp, ProgramState *programState) {
         switch (instructionIdx) {
             case STRING_INSTRUCTION:
                 if (line->num_of_words - line->has_label != 2) {
-                    PrintCommandInstructionErrorMessage(line->line_number,
+                    PrintCommandInstructionErrorMessage(line_number,
                                                         INCORRECT_NUM_OF_PARAMS_FOR_INSTRUCTION,
                                                         command, NULL);
                     return FAILURE;
                 }
-                currentProgramState->DC +=
-                        strlen(line->input_words[line->has_label + 1]) + 1;
-                printBinaryString(line->input_words[line->has_label + 1],
-                                  bin_fp);
+                statement->kind = STATEMENT_STRING;
+                statement->num_of_words = stringWordCount(parameter);
                 break;
             case DATA_INSTRUCTION:
                 if (line->num_of_words - line->has_label < 2) {
-                    PrintCommandInstructionErrorMessage(line->line_number,
+                    PrintCommandInstructionErrorMessage(line_number,
                                                         INCORRECT_NUM_OF_PARAMS_FOR_INSTRUCTION,
                                                         command, NULL);
                     return FAILURE;
                 }
-                currentProgramState->DC +=
+                statement->kind = STATEMENT_DATA;
+                statement->num_of_words =
                         line->num_of_words - line->has_label - 1;
-                for (i = line->has_label + 1; i < line->num_of_words; i++) {
-                    printBinaryDataPrameter(atoi(line->input_words[i]), bin_fp);
-                }
                 break;
         }
-        /* If it's neither a command nor an instruction, return FAILURE */
     } else {
-        PrintCommandInstructionErrorMessage(line->line_number,
+        /* If it's neither a command nor an instruction, return FAILURE */
+        PrintCommandInstructionErrorMessage(line_number,
                                             NOT_VALID_COMMAND_OR_INSTRUCTION,
                                             command, NULL);
+        return FAILURE;
     }
     return SUCCESS;
 }
+/******************************************************************************/
+/**
+ * Adds the extra word of an operand of a command. A register operand is
+ * written to the register field of its position.
+ *
+ * @param statement - The statement of the command.
+ * @param operand - The decoded operand.
+ * @param isSource - Whether it is the source operand.
+ * @param programState - The current state of the program.
+ */
+void addBinaryOperand(const Statement *statement,
+                      const StatementOperand *operand, int isSource,
+                      ProgramState *programState) {
+    if (operand->mode == REGISTER) {
+        addBinaryPrameterRegister(isSource ? operand->value.reg : 0,
+                                  isSource ? 0 : operand->value.reg,
+                                  programState->code);
+    } else if (operand->mode == NUMBER) {
+        addBinaryPrameterInteger(operand->value.number, programState->code);
+    } else if (operand->mode == LABEL) {
+        addBinaryPrameterLabel(operand->value.symbol, statement,
+                               programState->code, programState->fixups,
+                               programState->arena);
+    }
+}
+/******************************************************************************/
+/**
+ * Encodes a command without operands: only the command word.
+ *
+ * @param statement - The statement of the command.
+ * @param programState - The current state of the program.
+ */
+void encodeNoOperands(const Statement *statement, ProgramState *programState) {
+    addBinaryCommand(statement->opcode, OPERAND_TYPE_NONE, OPERAND_TYPE_NONE,
+                     programState->code);
+}
+/******************************************************************************/
+/**
+ * Encodes a command with a single operand, which is always the target operand.
+ *
+ * @param statement - The statement of the command.
+ * @param programState - The current state of the program.
+ */
+void encodeOneOperand(const Statement *statement, ProgramState *programState) {
+    const StatementOperand *target = &statement->operands[1];
+
+    addBinaryCommand(statement->opcode, OPERAND_TYPE_NONE, target->mode,
+                     programState->code);
+    addBinaryOperand(statement, target, 0, programState);
+}
+/******************************************************************************/
+/**
+ * Encodes a command with two register operands, which share a single word.
+ *
+ * @param statement - The statement of the command.
+ * @param programState - The current state of the program.
+ */
+void encodeRegisterPair(const Statement *statement,
+                        ProgramState *programState) {
+    addBinaryCommand(statement->opcode, REGISTER, REGISTER, programState->code);
+    addBinaryPrameterRegister(statement->operands[0].value.reg,
+                              statement->operands[1].value.reg,
+                              programState->code);
+}
+/******************************************************************************/
+/**
+ * Encodes a command with a source and a target operand, each in a word of its
+ * own.
+ *
+ * @param statement - The statement of the command.
+ * @param programState - The current state of the program.
+ */
+void encodeTwoOperands(const Statement *statement, ProgramState *programState) {
+    const StatementOperand *source = &statement->operands[0];
+    const StatementOperand *target = &statement->operands[1];
+
+    addBinaryCommand(statement->opcode, source->mode, target->mode,
+                     programState->code);
+    addBinaryOperand(statement, source, 1, programState);
+    addBinaryOperand(statement, target, 0, programState);
+}
+/******************************************************************************/
+/**
+ * Encodes a decoded statement, adding its words to the code or data image of
+ * the program. A command is encoded by the encoder of the shape recorded when
+ * it was decoded. Words referring to labels are recorded as fixups.
+ *
+ * @param statement - The statement.
+ * @param programState - A pointer to the ProgramState structure
+ *                       representing the current state of the program.
+ */
+void EncodeStatement(const Statement *statement, ProgramState *programState) {
+    const TokenizedLine *line = statement->source;
+
+    switch (statement->kind) {
+        case STATEMENT_COMMAND:
+            commandEncoders[(int) statement->shape](statement, programState);
+            break;
+        case STATEMENT_STRING:
+            addBinaryString(line->words[line->has_label + 1],
+                            programState->data);
+            break;
+        case STATEMENT_DATA:
+            addBinaryDataPrameters(line->words + line->has_label + 1,
+                                   statement->num_of_words,
+                                   programState->data);
+            break;
+        case STATEMENT_ENTRY:
+            push_back(programState->fixups,
+                      new_fixup(programState->arena,
+                                statement->operands[0].value.symbol, -1,
+                                statement->line_number, line->origin_file,
+                                line->origin_line));
+            break;
+    }
+}
 /******************************************************************************/
\ No newline at end of file
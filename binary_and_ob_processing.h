@@ -5,9 +5,9 @@
 * Description:          This header file contains function declarations
 *                       necessary for binary and .ob file processing for
 *                       our custom compiler. This includes
-*                       functions to process each line of assembly input and
+*                       functions to decode each line of assembly input and
 *                       generate appropriate binary output and also for
-*                       conversion of binary output to base64 format.
+*                       writing it to a packed binary object file.
 \******************************************************************************/
 #ifndef MAMAN14_BINARY_AND_OB_PROCESSING_H
 #define MAMAN14_BINARY_AND_OB_PROCESSING_H
@@ -17,30 +17,93 @@
 #include "utils.h" /* for the Status enum */
 #include "program_constants.h" /* for the ProgramState struct */
 
+/*************************** Binary Object Format *****************************/
+/* An optional packed and relocatable alternative to the .ob file
+ * (--binary-object). All the integers are unsigned and little-endian, and
+ * every section starts at a multiple of 4 bytes, so the file can be read in
+ * place once mapped:
+ *
+ *   Offset  Size  Field
+ *   0       4     OBJECT_MAGIC
+ *   4       2     OBJECT_VERSION
+ *   6       2     OBJECT_HEADER_SIZE, the offset of the words
+ *   8       4     IC, the number of instruction words
+ *   12      4     DC, the number of data words
+ *   16      4     The number of entry symbols
+ *   20      4     The number of extern symbols
+ *   24      4     The number of relocations
+ *   28      4     The address the words were assembled for, START_ADDRESS
+ *   32            The instruction words followed by the data words, two
+ *                 12-bit words in every 3 bytes, most significant bits first.
+ *                 An odd last word is padded with a zero word.
+ *   (aligned)     The symbol table: the entry symbols followed by the extern
+ *                 symbols, each a OBJECT_SYMBOL_SIZE record: the name, padded
+ *                 with '\0' to MAX_LABEL_LENGTH bytes, and a 4 bytes value,
+ *                 the address of an entry symbol or 0 for an extern symbol.
+ *                 A symbol is referred to by its index in the table, and each
+ *                 extern symbol is listed once.
+ *   (aligned)     The relocation table, in increasing word order: a
+ *                 OBJECT_RELOCATION_SIZE record for each word that refers to
+ *                 a label, its 4 bytes index among the words, a 2 bytes kind
+ *                 and the 2 bytes index of its symbol:
+ *                 RELOCATION_BASE   - The word holds the address of a label of
+ *                                     the program, to which the difference of
+ *                                     the load address and the assembled
+ *                                     address is added. The symbol is unused.
+ *                 RELOCATION_SYMBOL - The word refers to an extern symbol,
+ *                                     whose address is added to it.
+ *                 The addresses are added to the value field of the words.
+ *
+ * A loader relocates the words to any load address in a single pass over the
+ * relocation table.
+ */
+#define OBJECT_MAGIC "AS12"
+#define OBJECT_VERSION 2
+#define OBJECT_HEADER_SIZE 32
+#define OBJECT_SYMBOL_SIZE (MAX_LABEL_LENGTH + 4)
+#define OBJECT_RELOCATION_SIZE 8
+
+/* The kinds of relocations */
+#define RELOCATION_BASE 0
+#define RELOCATION_SYMBOL 1
+
 /**
- * Converts binary data from a given file to Base64 format, and writes it to
- * an output file.
+ * Writes the words of the program, its symbol table and its relocation table
+ * to a binary object file, in the format described above.
  *
- * @param input_file The path of the file with binary data.
- * @param output_file The path of the file to write the Base64 output.
- * @param IC Instruction counter, represents the amount of instructions.
- * @param DC Data counter, represents the amount of data.
+ * @param output_file The path of the binary object file.
+ * @param programState A pointer to the ProgramState structure of the program,
+ *                     after its label references were resolved.
  */
-void
-binaryToBase64(const char *input_file, const char *output_file, int IC, int DC);
+void writeBinaryObject(const char *output_file, ProgramState *programState);
 
 /**
- * Processes a line of assembly code, interprets the commands, parameters, and
- * labels, and writes the equivalent binary code to a binary output file.
+ * Decodes a line of assembly code into a statement: interprets the command or
+ * directive and its parameters, validates them, and records the addressing
+ * modes, operands and number of words of the line. '.entry' and '.extern'
+ * directives mark their labels.
  *
- * @param line A pointer to the line to process.
- * @param bin_fp A pointer to the file to write the binary output.
+ * @param line The tokenized line to decode.
+ * @param line_number The line number in the .am file.
+ * @param statement The statement to fill.
  * @param programState A pointer to the ProgramState structure with the current
  *                     state of the program.
  *
  * @return Status indicating success or failure of the operation.
  */
-Status ProcessLine(Line *line, FILE *bin_fp, ProgramState *programState);
+Status DecodeLine(const TokenizedLine *line, int line_number,
+                  Statement *statement, ProgramState *programState);
+
+/**
+ * Adds the binary words of a decoded statement to the code or data image of
+ * the program.
+ * Words referring to labels are recorded as fixups, patched by ResolveFixups.
+ *
+ * @param statement A pointer to the statement to encode.
+ * @param programState A pointer to the ProgramState structure with the current
+ *                     state of the program.
+ */
+void EncodeStatement(const Statement *statement, ProgramState *programState);
 
 #endif
 
@@ -0,0 +1,211 @@
+/*********************************FILE__HEADER*********************************\
+* File:                 fuzz_assembler.c
+* Authors:              Daniel Brodsky & Lior Katav
+* Date:                 August-2023
+* Description:          This file is a fuzzing target of the assembler, for
+*                       libFuzzer, separate from the assembler itself. Each
+*                       input is the contents of a source file, which is
+*                       preprocessed, its labels checked, parsed and encoded
+*                       into the code and data images in memory, without any
+*                       file I/O: '.include' isn't allowed, no .am or output
+*                       file is written, and nothing exits the process but a
+*                       failed allocation.
+*
+*                       The ProgramState is allocated once and reset before
+*                       each assembly, as the assembler resets it for every
+*                       file. Each input is assembled in two passes and then
+*                       in one pass (--one-pass): when both succeed, their
+*                       images must be the same, so a state left over by the
+*                       previous assembly, or a difference between the two
+*                       modes, aborts like a crash.
+*
+*                       Built with -DFUZZ_STANDALONE, the file has a main of
+*                       its own that runs the target on the files given as
+*                       arguments and prints the time each of them took, to
+*                       reproduce a crash or a slow input without libFuzzer.
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "program_constants.h"
+#include "program_state.h"
+#include "macro_processing.h"
+#include "label_processing.h"
+#include "am_file_processing.h"
+#include "print_error.h"
+#include "word_image.h"
+#include "utils.h"
+
+/******************************** Definitions *********************************/
+/* The name of the source file the errors of an input are reported in */
+#define FUZZ_FILE_NAME "fuzz.as"
+
+/******************* Global variable definitions ******************************/
+static ProgramState fuzzState;
+static int fuzzStateInitialized = 0;
+
+/* The words of the two passes assembly, compared to the one pass assembly */
+static unsigned short *fuzzWords = NULL;
+static int fuzzWordsCapacity = 0;
+
+/**************************** Forward Declarations ****************************/
+int LLVMFuzzerTestOneInput(const unsigned char *data, size_t size);
+
+/************************* Functions  Implementations *************************/
+/**
+ * Assembles a source held in memory with the fuzzing program state, the same
+ * stages as the assembler runs for a file, but without writing its output.
+ *
+ * @param data - The contents of the source file.
+ * @param size - The number of bytes of the contents.
+ * @param onePass - Whether to assemble in one pass.
+ * @return SUCCESS if the source was assembled without errors.
+ */
+Status assembleBuffer(const unsigned char *data, size_t size, int onePass) {
+    Status status;
+
+    resetProgramState(&fuzzState);
+    fuzzState.onePass = onePass;
+    SetErrorOrigin(NULL, 0);
+
+    status = preProcessBuffer((const char *) data, size, FUZZ_FILE_NAME,
+                              &fuzzState);
+    if (SUCCESS != status) {
+        return FAILURE;
+    }
+    if (!onePass && SUCCESS != checkLabels(&fuzzState)) {
+        status = FAILURE;
+    }
+    if (SUCCESS != ParseFile(&fuzzState)) {
+        status = FAILURE;
+    }
+    /* A source with errors is only checked, as by the assembler */
+    if (SUCCESS != status) {
+        CheckReferences(&fuzzState);
+        return FAILURE;
+    }
+    EncodeFile(&fuzzState);
+    return ResolveFixups(&fuzzState);
+}
+/******************************************************************************/
+/**
+ * Keeps the words of the code image followed by those of the data image.
+ */
+void keepWords(void) {
+    int size = fuzzState.code->size + fuzzState.data->size;
+
+    /* Allocated even for no words, so it's never NULL when compared */
+    if (fuzzWords == NULL || size > fuzzWordsCapacity) {
+        my_free(fuzzWords);
+        fuzzWords = my_malloc(sizeof(unsigned short) * (size + 1));
+        if (fuzzWords == NULL) {
+            fprintf(stderr, "Error allocating memory for the fuzzed words\n");
+            exit(1);
+        }
+        fuzzWordsCapacity = size;
+    }
+    memcpy(fuzzWords, fuzzState.code->words,
+           sizeof(unsigned short) * fuzzState.code->size);
+    memcpy(fuzzWords + fuzzState.code->size, fuzzState.data->words,
+           sizeof(unsigned short) * fuzzState.data->size);
+}
+/******************************************************************************/
+/**
+ * The entry point of libFuzzer: assembles an input in two passes and in one
+ * pass, and aborts if both succeed with different images.
+ *
+ * @param data - The input, the contents of a source file.
+ * @param size - The number of bytes of the input.
+ * @return 0, as libFuzzer expects.
+ */
+int LLVMFuzzerTestOneInput(const unsigned char *data, size_t size) {
+    Status twoPasses;
+    int codeSize, dataSize, labelsSize;
+
+    if (!fuzzStateInitialized) {
+        initProgramState(&fuzzState);
+        fuzzStateInitialized = 1;
+    }
+
+    twoPasses = assembleBuffer(data, size, 0);
+    codeSize = fuzzState.code->size;
+    dataSize = fuzzState.data->size;
+    labelsSize = fuzzState.labels.size;
+    if (SUCCESS == twoPasses) {
+        keepWords();
+    }
+
+    if (SUCCESS == assembleBuffer(data, size, 1) && SUCCESS == twoPasses &&
+        (codeSize != fuzzState.code->size ||
+         dataSize != fuzzState.data->size ||
+         labelsSize != fuzzState.labels.size ||
+         memcmp(fuzzWords, fuzzState.code->words,
+                sizeof(unsigned short) * codeSize) != 0 ||
+         memcmp(fuzzWords + codeSize, fuzzState.data->words,
+                sizeof(unsigned short) * dataSize) != 0)) {
+        fprintf(stderr, "The one pass assembly differs from the two passes "
+                        "one\n");
+        abort();
+    }
+    return 0;
+}
+/******************************************************************************/
+#ifdef FUZZ_STANDALONE
+/**
+ * Runs the target on each of the files given as arguments, and prints the
+ * time it took for each.
+ *
+ * @param argc - The number of command-line arguments.
+ * @param argv[] - The names of the input files.
+ *
+ * @return 0 if all the files were read, 1 otherwise.
+ */
+int main(int argc, char *argv[]) {
+    FILE *file;
+    unsigned char *data;
+    long size;
+    clock_t start;
+    int i, ret = 0;
+
+    for (i = 1; i < argc; i++) {
+        file = fopen(argv[i], "rb");
+        if (file == NULL || fseek(file, 0, SEEK_END) != 0 ||
+            (size = ftell(file)) < 0) {
+            fprintf(stderr, "fuzz_replay: Couldn't read %s\n", argv[i]);
+            if (file != NULL) {
+                fclose(file);
+            }
+            ret = 1;
+            continue;
+        }
+        rewind(file);
+        data = my_malloc(size > 0 ? (size_t) size : 1);
+        if (data == NULL) {
+            fprintf(stderr, "fuzz_replay: Error allocating memory\n");
+            exit(1);
+        }
+        if (fread(data, 1, (size_t) size, file) != (size_t) size) {
+            fprintf(stderr, "fuzz_replay: Couldn't read %s\n", argv[i]);
+            ret = 1;
+        } else {
+            start = clock();
+            LLVMFuzzerTestOneInput(data, (size_t) size);
+            fprintf(stderr, "%s: %ld bytes, %.3f ms\n", argv[i], size,
+                    (double) (clock() - start) * 1000 / CLOCKS_PER_SEC);
+        }
+        my_free(data);
+        fclose(file);
+    }
+
+    if (fuzzStateInitialized) {
+        freeProgramState(&fuzzState);
+    }
+    my_free(fuzzWords);
+    return ret;
+}
+#endif
+/******************************************************************************/
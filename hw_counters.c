@@ -0,0 +1,240 @@
+/*********************************FILE__HEADER*********************************\
+* File:					hw_counters.c
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			Implementation of the hardware performance counters.
+*                       Each event is opened on its own, so an event the CPU
+*                       or the virtual machine doesn't have is reported as
+*                       n/a without losing the others. When the kernel has
+*                       more events open than counters, it multiplexes them,
+*                       and the counts are scaled by the time each event was
+*                       actually counting. On systems other than Linux the
+*                       counters are always unavailable.
+\******************************************************************************/
+
+#ifdef __linux__
+/* For syscall, the rest of the file is C89 */
+#define _DEFAULT_SOURCE
+#endif
+
+/******************************** Header Files ********************************/
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "hw_counters.h"
+
+/***************************** Enums  Definitions *****************************/
+/* The counted events */
+typedef enum {
+    HW_CYCLES,
+    HW_INSTRUCTIONS,
+    HW_BRANCH_MISSES,
+    HW_L1D_MISSES,
+    HW_LLC_MISSES,
+    NUM_OF_HW_EVENTS
+} HwEvent;
+
+/******************* Global variable definitions ******************************/
+/* The file descriptor of each event, or -1 if it couldn't be opened */
+static int hwEventFds[NUM_OF_HW_EVENTS];
+static int hwCountersEnabled = 0;
+
+/* The counts of each event in each stage, over all the files */
+static double hwCounts[NUM_OF_STATS_STAGES][NUM_OF_HW_EVENTS];
+static long hwLines = 0;
+
+/************************* Functions  Implementations *************************/
+#ifdef __linux__
+/**
+ * Opens a counter of the user space of this process.
+ *
+ * @param type - The perf type of the event.
+ * @param config - The perf config of the event.
+ * @return The file descriptor of the counter, or -1 with errno set.
+ */
+int openHwEvent(unsigned int type, unsigned long config) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+/******************************************************************************/
+/**
+ * Returns the perf config of a read miss of a cache.
+ *
+ * @param cache - The PERF_COUNT_HW_CACHE_* id of the cache.
+ */
+unsigned long cacheMissConfig(unsigned long cache) {
+    return cache | ((unsigned long) PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           ((unsigned long) PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+#endif
+/******************************************************************************/
+/**
+ * Opens the counters. If they are unavailable, prints the reason to stderr
+ * and leaves them disabled.
+ */
+void hw_counters_enable(void) {
+    int i;
+
+    for (i = 0; i < NUM_OF_HW_EVENTS; i++) {
+        hwEventFds[i] = -1;
+    }
+#ifdef __linux__
+    hwEventFds[HW_CYCLES] = openHwEvent(PERF_TYPE_HARDWARE,
+                                        PERF_COUNT_HW_CPU_CYCLES);
+    if (hwEventFds[HW_CYCLES] == -1) {
+        fprintf(stderr, "Hardware counters unavailable: perf_event_open: %s\n",
+                strerror(errno));
+        return;
+    }
+    hwEventFds[HW_INSTRUCTIONS] = openHwEvent(PERF_TYPE_HARDWARE,
+                                              PERF_COUNT_HW_INSTRUCTIONS);
+    hwEventFds[HW_BRANCH_MISSES] = openHwEvent(PERF_TYPE_HARDWARE,
+                                               PERF_COUNT_HW_BRANCH_MISSES);
+    hwEventFds[HW_L1D_MISSES] = openHwEvent(
+            PERF_TYPE_HW_CACHE, cacheMissConfig(PERF_COUNT_HW_CACHE_L1D));
+    hwEventFds[HW_LLC_MISSES] = openHwEvent(
+            PERF_TYPE_HW_CACHE, cacheMissConfig(PERF_COUNT_HW_CACHE_LL));
+    hwCountersEnabled = 1;
+#else
+    fprintf(stderr, "Hardware counters unavailable: not supported on this "
+                    "system\n");
+#endif
+}
+/******************************************************************************/
+/**
+ * Starts counting a stage.
+ *
+ * @param stage - The stage.
+ */
+void hw_counters_start_stage(StatsStage stage) {
+#ifdef __linux__
+    int i;
+
+    if (!hwCountersEnabled) {
+        return;
+    }
+    for (i = 0; i < NUM_OF_HW_EVENTS; i++) {
+        if (hwEventFds[i] != -1) {
+            ioctl(hwEventFds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(hwEventFds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+/******************************************************************************/
+/**
+ * Stops counting a stage, adding its counts to the stage.
+ *
+ * @param stage - The stage.
+ */
+void hw_counters_end_stage(StatsStage stage) {
+#ifdef __linux__
+    __u64 values[3]; /* The count, and the time enabled and running */
+    int i;
+
+    if (!hwCountersEnabled) {
+        return;
+    }
+    for (i = 0; i < NUM_OF_HW_EVENTS; i++) {
+        if (hwEventFds[i] != -1) {
+            ioctl(hwEventFds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (i = 0; i < NUM_OF_HW_EVENTS; i++) {
+        if (hwEventFds[i] == -1 ||
+            read(hwEventFds[i], values, sizeof(values)) != sizeof(values)) {
+            continue;
+        }
+        if (values[2] > 0 && values[2] < values[1]) {
+            hwCounts[stage][i] += (double) values[0] * (double) values[1] /
+                                  (double) values[2];
+        } else {
+            hwCounts[stage][i] += (double) values[0];
+        }
+    }
+#endif
+}
+/******************************************************************************/
+/**
+ * Adds the source lines of a processed file, that the counts are divided by.
+ *
+ * @param lines - The number of lines.
+ */
+void hw_counters_add_lines(long lines) {
+    hwLines += lines;
+}
+/******************************************************************************/
+/**
+ * Prints a count per source line, or n/a for an event that isn't counted.
+ */
+void printPerLine(int stage, HwEvent event) {
+    if (hwEventFds[event] == -1) {
+        fprintf(stderr, " %13s", "n/a");
+    } else {
+        fprintf(stderr, " %13.2f", hwCounts[stage][event] / (double) hwLines);
+    }
+}
+/******************************************************************************/
+/**
+ * Reports the counts of each stage to stderr, and closes the counters.
+ */
+void hw_counters_report(void) {
+    int stage, i;
+
+    if (!hwCountersEnabled) {
+        return;
+    }
+    if (hwLines < 1) {
+        hwLines = 1;
+    }
+    fprintf(stderr, "Hardware counters per source line (%ld lines):\n",
+            hwLines);
+    fprintf(stderr, "  %-20s %13s %13s %6s %13s %13s %13s\n", "stage",
+            "cycles", "instructions", "IPC", "branch-misses", "L1D-misses",
+            "LLC-misses");
+    for (stage = 0; stage < NUM_OF_STATS_STAGES; stage++) {
+        fprintf(stderr, "  %-20s", stats_stage_name((StatsStage) stage));
+        printPerLine(stage, HW_CYCLES);
+        printPerLine(stage, HW_INSTRUCTIONS);
+        if (hwEventFds[HW_INSTRUCTIONS] != -1 &&
+            hwCounts[stage][HW_CYCLES] > 0) {
+            fprintf(stderr, " %6.2f", hwCounts[stage][HW_INSTRUCTIONS] /
+                                      hwCounts[stage][HW_CYCLES]);
+        } else {
+            fprintf(stderr, " %6s", "n/a");
+        }
+        for (i = HW_BRANCH_MISSES; i < NUM_OF_HW_EVENTS; i++) {
+            printPerLine(stage, (HwEvent) i);
+        }
+        fputc('\n', stderr);
+    }
+
+#ifdef __linux__
+    for (i = 0; i < NUM_OF_HW_EVENTS; i++) {
+        if (hwEventFds[i] != -1) {
+            close(hwEventFds[i]);
+            hwEventFds[i] = -1;
+        }
+    }
+#endif
+    hwCountersEnabled = 0;
+}
+/******************************************************************************/
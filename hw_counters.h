@@ -0,0 +1,58 @@
+/*********************************FILE__HEADER*********************************\
+* File:					hw_counters.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			API of the hardware performance counters (--hw-counters).
+*                       The cycles, instructions, branch misses, L1 data cache
+*                       misses and last level cache misses of the process are
+*                       counted with perf_event_open around each of the stages
+*                       timed by the statistics, and reported at exit per stage
+*                       and per source line, along with the instructions per
+*                       cycle.
+*
+*                       Only the user space of the process itself is counted,
+*                       which the kernel allows without privileges unless
+*                       perf_event_paranoid is above 2. Where the counters
+*                       can't be opened, a single message tells why and the
+*                       assembler runs as usual.
+\******************************************************************************/
+
+#ifndef MAMAN14_HW_COUNTERS_H
+#define MAMAN14_HW_COUNTERS_H
+
+#include "stats.h" /* for the StatsStage enum */
+
+/************************* Functions Declarations *************************/
+/**
+ * Opens the counters. If they are unavailable, prints the reason to stderr
+ * and leaves them disabled.
+ */
+void hw_counters_enable(void);
+
+/**
+ * Starts counting a stage.
+ *
+ * @param stage - The stage.
+ */
+void hw_counters_start_stage(StatsStage stage);
+
+/**
+ * Stops counting a stage, adding its counts to the stage.
+ *
+ * @param stage - The stage.
+ */
+void hw_counters_end_stage(StatsStage stage);
+
+/**
+ * Adds the source lines of a processed file, that the counts are divided by.
+ *
+ * @param lines - The number of lines.
+ */
+void hw_counters_add_lines(long lines);
+
+/**
+ * Reports the counts of each stage to stderr, and closes the counters.
+ */
+void hw_counters_report(void);
+
+#endif
@@ -0,0 +1,96 @@
+/*********************************FILE__HEADER*********************************\
+*
+* File:                 include_cache.c
+* Authors:              Daniel Brodsky & Lior Katav
+* Date:                 August-2023
+* Description:          This file contains the implementation of the include
+*                       cache, which keeps every file included by an '.include'
+*                       directive for the whole run of the assembler.
+*                       The cache is a vector of IncludedFile pointers, kept
+*                       in the order the files were first included.
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "include_cache.h"
+#include "utils.h"  /* my_strdup function */
+
+/************************* Functions  Implementations *************************/
+/**
+ * Finds a file in the include cache by its path.
+ *
+ * @param cache - The include cache.
+ * @param path - The path of the file.
+ * @return - A pointer to the IncludedFile, or NULL if it isn't in the cache.
+ */
+IncludedFile *findIncludedFile(Vector *cache, const char *path) {
+    int i;
+    IncludedFile *includedFile = NULL;
+    for (i = 0; i < cache->size; ++i) {
+        includedFile = (IncludedFile *) cache->items[i];
+        if (strcmp(includedFile->path, path) == 0) {
+            return includedFile;
+        }
+    }
+    return NULL;
+}
+/******************************************************************************/
+/**
+ * Adds a new file to the include cache.
+ *
+ * @param cache - The include cache.
+ * @param path - The path of the file.
+ * @return - A pointer to the new IncludedFile.
+ *
+ * The function allocates the IncludedFile and its vectors, and marks it as
+ * in progress until the preprocessor is done with it. The program exits if
+ * the allocation fails.
+ */
+IncludedFile *addIncludedFile(Vector *cache, const char *path) {
+    IncludedFile *includedFile = my_malloc(sizeof(IncludedFile));
+    if (includedFile == NULL) {
+        exit(1);
+    }
+    includedFile->path = my_strdup(path);
+    includedFile->lines = new_vector();
+    includedFile->arena = new_arena();
+    includedFile->macros = new_macro_vector();
+    includedFile->visibleMacros = new_macro_vector();
+    includedFile->includes = new_vector();
+    includedFile->state = INCLUDE_IN_PROGRESS;
+    push_back(cache, includedFile);
+    return includedFile;
+}
+/******************************************************************************/
+/**
+ * Frees the include cache.
+ *
+ * @param cache - The include cache.
+ *
+ * The lines and includes vectors only refer to items owned elsewhere,
+ * so they are freed without their items, and the lines are freed with
+ * the arena of the file. The macros of an included file
+ * are shared with its includers, and are freed only here. Its visible
+ * macros are all shared by then, and may belong to other included files,
+ * so these vectors are released before any macro is freed.
+ */
+void freeIncludeCache(Vector *cache) {
+    int i;
+    IncludedFile *includedFile = NULL;
+    for (i = 0; i < cache->size; ++i) {
+        includedFile = (IncludedFile *) cache->items[i];
+        free_macro_vector(includedFile->visibleMacros);
+    }
+    for (i = 0; i < cache->size; ++i) {
+        includedFile = (IncludedFile *) cache->items[i];
+        my_free(includedFile->path);
+        free_vector_shallow(includedFile->lines);
+        free_arena(includedFile->arena);
+        free_shared_macros(includedFile->macros);
+        free_vector_shallow(includedFile->includes);
+    }
+    free_vector(cache);
+}
+/******************************************************************************/
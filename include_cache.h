@@ -0,0 +1,60 @@
+/*********************************FILE__HEADER*********************************\
+* File:					include_cache.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			This header file contains the definition of the
+*                       IncludedFile struct and the functions of the include
+*                       cache. Every file named by an '.include' directive is
+*                       read, tokenized and scanned for macros once per run, and
+*                       the cached result is shared by every file that includes it.
+\******************************************************************************/
+
+#ifndef MAMAN14_INCLUDE_CACHE_H
+#define MAMAN14_INCLUDE_CACHE_H
+
+#include "vector.h" /* for Vector struct */
+#include "macro.h" /* for MacroVector struct */
+#include "arena.h" /* for Arena struct */
+
+/***************************** Enums  Definitions *****************************/
+/* The processing state of an included file */
+typedef enum {
+    INCLUDE_IN_PROGRESS, /* Still being preprocessed, including it again is a cycle */
+    INCLUDE_DONE,
+    INCLUDE_FAILED
+} IncludeState;
+
+/**************************** Structs  Definitions ****************************/
+/* A file included by '.include', preprocessed once and shared by all its includers */
+typedef struct {
+    char *path; /* The path of the file, also the origin of its lines in error messages */
+    Vector *lines; /* The tokenized lines of the file after expansion, in order */
+    Arena *arena; /* Owns the tokenized lines of the file and of its macros */
+    MacroVector *macros; /* The macros defined in the file itself, owned by it */
+    MacroVector *visibleMacros; /* Its macros and those of its includes, the scope of its macros */
+    Vector *includes; /* The IncludedFiles directly included by the file */
+    IncludeState state;
+} IncludedFile;
+
+/******************************************************************************/
+/**
+ * Finds a file in the include cache.
+ * @param cache - The include cache, a Vector of IncludedFile pointers.
+ * @param path - The path of the file.
+ * @return A pointer to the IncludedFile, or NULL if the file wasn't included yet.
+ */
+IncludedFile *findIncludedFile(Vector *cache, const char *path);
+/**
+ * Adds a new, empty entry to the include cache, in the INCLUDE_IN_PROGRESS state.
+ * @param cache - The include cache.
+ * @param path - The path of the file.
+ * @return A pointer to the new IncludedFile.
+ */
+IncludedFile *addIncludedFile(Vector *cache, const char *path);
+/**
+ * Frees the include cache and all the files, lines and macros it holds.
+ * @param cache - The include cache.
+ */
+void freeIncludeCache(Vector *cache);
+/******************************************************************************/
+#endif
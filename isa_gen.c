@@ -0,0 +1,535 @@
+/*********************************FILE__HEADER*********************************\
+* File:                 isa_gen.c
+* Authors:              Daniel Brodsky & Lior Katav
+* Date:                 August-2023
+* Description:          This file is a build-time generator, separate from the
+*                       assembler. It reads the machine description of the
+*                       instruction set (isa.def) and writes isa_tables.h: the
+*                       static const tables of the mnemonics, their hash table,
+*                       the operand types, word counts and command word
+*                       templates, and the bit fields of the words. Errors in
+*                       the description are reported with their line number
+*                       and fail the build.
+*
+*                       Usage: isa_gen <description file> <output header>
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******************************** Definitions *********************************/
+#define MAX_DESCRIPTION_LINE 256
+#define MAX_NAME_LENGTH 32
+#define MAX_COMMANDS 64
+#define MAX_REGISTERS 64
+#define MAX_HASH_SIZE 1024
+
+/* The word width of the .ob and .obj output formats */
+#define OUTPUT_WORD_BITS 12
+
+/* Operand addressing modes, as a set of bits */
+#define MODE_IMMEDIATE 1
+#define MODE_DIRECT 2
+#define MODE_REGISTER 4
+
+/**************************** Structs  Definitions ****************************/
+/* A named bit field of a word */
+typedef struct {
+    const char *name;
+    int shift;
+    int width; /* 0 until the field is described */
+} Field;
+
+/* A named code: an addressing mode or ARE bits */
+typedef struct {
+    const char *name;
+    int code; /* -1 until the code is described */
+} Code;
+
+typedef struct {
+    char mnemonic[MAX_NAME_LENGTH];
+    int opcode;
+    int sourceModes;
+    int targetModes;
+} Command;
+
+typedef struct {
+    char name[MAX_NAME_LENGTH];
+    int number;
+} Register;
+
+/******************* Global variable definitions ******************************/
+static Field fields[] = {
+        {"source",          0, 0},
+        {"opcode",          0, 0},
+        {"target",          0, 0},
+        {"are",             0, 0},
+        {"value",           0, 0},
+        {"source_register", 0, 0},
+        {"target_register", 0, 0}
+};
+static const int fieldsSize = sizeof(fields) / sizeof(Field);
+
+static Code modes[] = {{"number", -1}, {"label", -1}, {"register", -1}};
+static const int modesSize = sizeof(modes) / sizeof(Code);
+
+static Code ares[] = {{"absolute", -1}, {"external", -1}, {"relocatable", -1}};
+static const int aresSize = sizeof(ares) / sizeof(Code);
+
+/* The OperandType of program_constants.h of each supported set of modes */
+static const char *operandTypeNames[] = {
+        "OPERAND_TYPE_NONE",               /* - */
+        "OPERAND_TYPE_NUMBER",             /* I */
+        "OPERAND_TYPE_LABEL",              /* D */
+        NULL,                              /* ID */
+        "OPERAND_TYPE_REGISTER",           /* R */
+        NULL,                              /* IR */
+        "OPERAND_TYPE_LABEL_OR_REGISTER",  /* DR */
+        "OPERAND_TYPE_ALL"                 /* IDR */
+};
+
+static Command commands[MAX_COMMANDS];
+static int commandsSize = 0;
+
+static Register registers[MAX_REGISTERS];
+static int registersSize = 0;
+
+static int wordBits = 0;
+
+static const char *descriptionFile = NULL;
+static int descriptionLine = 0;
+
+/************************* Functions  Implementations *************************/
+/**
+ * Reports an error in the machine description and stops the generator.
+ *
+ * @param message - The error message.
+ * @param argument - The word the error is about, or NULL.
+ */
+void descriptionError(const char *message, const char *argument) {
+    if (descriptionLine > 0) {
+        fprintf(stderr, "isa_gen: %s:%d: %s", descriptionFile,
+                descriptionLine, message);
+    } else {
+        fprintf(stderr, "isa_gen: %s: %s", descriptionFile, message);
+    }
+    if (argument != NULL) {
+        fprintf(stderr, " '%s'", argument);
+    }
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+/******************************************************************************/
+/**
+ * Hashes a mnemonic. The assembler's lookupCommand computes the same hash.
+ *
+ * @param mnemonic - The mnemonic to hash.
+ * @param multiplier - The multiplier of the hash.
+ * @param size - The size of the hash table, a power of 2.
+ * @return The slot of the mnemonic in the hash table.
+ */
+unsigned long hashMnemonic(const char *mnemonic, unsigned long multiplier,
+                           unsigned long size) {
+    unsigned long hash = 0;
+    while (*mnemonic) {
+        hash = hash * multiplier + (unsigned char) *mnemonic++;
+    }
+    return hash & (size - 1);
+}
+
+/******************************************************************************/
+/**
+ * Finds a named field or code.
+ *
+ * @return The index of the name, or -1 if it isn't found.
+ */
+int findField(const char *name) {
+    int i;
+    for (i = 0; i < fieldsSize; i++) {
+        if (strcmp(fields[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int findCode(Code *codes, int size, const char *name) {
+    int i;
+    for (i = 0; i < size; i++) {
+        if (strcmp(codes[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/******************************************************************************/
+/**
+ * Parses the addressing modes of an operand.
+ *
+ * @param text - The modes: any of I, D and R, or - for no operand.
+ * @return The set of modes.
+ */
+int parseModes(const char *text) {
+    int modeSet = 0;
+    const char *mode;
+    if (strcmp(text, "-") == 0) {
+        return 0;
+    }
+    for (mode = text; *mode; mode++) {
+        switch (*mode) {
+            case 'I':
+                modeSet |= MODE_IMMEDIATE;
+                break;
+            case 'D':
+                modeSet |= MODE_DIRECT;
+                break;
+            case 'R':
+                modeSet |= MODE_REGISTER;
+                break;
+            default:
+                descriptionError("Unknown addressing modes", text);
+        }
+    }
+    if (operandTypeNames[modeSet] == NULL) {
+        descriptionError("Unsupported combination of addressing modes", text);
+    }
+    return modeSet;
+}
+
+/******************************************************************************/
+/**
+ * Parses a line of the machine description into the global tables.
+ *
+ * @param line - The line, without its comment.
+ */
+void parseDescriptionLine(char *line) {
+    char directive[MAX_NAME_LENGTH], name[MAX_NAME_LENGTH];
+    char source[MAX_NAME_LENGTH], target[MAX_NAME_LENGTH];
+    int first, second, idx, count;
+
+    count = sscanf(line, "%31s", directive);
+    if (count != 1) {
+        return; /* An empty line */
+    }
+
+    if (strcmp(directive, "word") == 0) {
+        if (sscanf(line, "%*s %d", &wordBits) != 1) {
+            descriptionError("Expected: word <bits>", NULL);
+        }
+    } else if (strcmp(directive, "field") == 0) {
+        if (sscanf(line, "%*s %31s %d %d", name, &first, &second) != 3) {
+            descriptionError("Expected: field <name> <shift> <width>", NULL);
+        }
+        idx = findField(name);
+        if (idx == -1) {
+            descriptionError("Unknown field", name);
+        }
+        fields[idx].shift = first;
+        fields[idx].width = second;
+    } else if (strcmp(directive, "mode") == 0 ||
+               strcmp(directive, "are") == 0) {
+        Code *codes = directive[0] == 'm' ? modes : ares;
+        int size = directive[0] == 'm' ? modesSize : aresSize;
+        if (sscanf(line, "%*s %31s %d", name, &first) != 2) {
+            descriptionError("Expected a name and a code", NULL);
+        }
+        idx = findCode(codes, size, name);
+        if (idx == -1) {
+            descriptionError("Unknown name", name);
+        }
+        codes[idx].code = first;
+    } else if (strcmp(directive, "register") == 0) {
+        if (sscanf(line, "%*s %31s %d", name, &first) != 2) {
+            descriptionError("Expected: register <name> <number>", NULL);
+        }
+        if (registersSize == MAX_REGISTERS) {
+            descriptionError("Too many registers", NULL);
+        }
+        strcpy(registers[registersSize].name, name);
+        registers[registersSize++].number = first;
+    } else if (strcmp(directive, "command") == 0) {
+        if (sscanf(line, "%*s %31s %d %31s %31s", name, &first, source,
+                   target) != 4) {
+            descriptionError("Expected: command <mnemonic> <opcode> "
+                             "<source modes> <target modes>", NULL);
+        }
+        if (commandsSize == MAX_COMMANDS) {
+            descriptionError("Too many commands", NULL);
+        }
+        for (idx = 0; idx < commandsSize; idx++) {
+            if (strcmp(commands[idx].mnemonic, name) == 0) {
+                descriptionError("Duplicate command", name);
+            }
+        }
+        strcpy(commands[commandsSize].mnemonic, name);
+        commands[commandsSize].opcode = first;
+        commands[commandsSize].sourceModes = parseModes(source);
+        commands[commandsSize].targetModes = parseModes(target);
+        if (commands[commandsSize].sourceModes != 0 &&
+            commands[commandsSize].targetModes == 0) {
+            descriptionError("A single operand must be the target operand of",
+                             name);
+        }
+        commandsSize++;
+    } else {
+        descriptionError("Unknown directive", directive);
+    }
+}
+
+/******************************************************************************/
+/**
+ * Checks that a value fits in a field.
+ */
+void checkFits(int value, const char *fieldName, const char *what) {
+    Field *field = &fields[findField(fieldName)];
+    if (value < 0 || value >= (1 << field->width)) {
+        descriptionError("Doesn't fit in its field", what);
+    }
+}
+
+/******************************************************************************/
+/**
+ * Checks that the description is complete and consistent.
+ */
+void checkDescription(void) {
+    int i;
+
+    /* Errors of the whole description have no line */
+    descriptionLine = 0;
+    if (wordBits != OUTPUT_WORD_BITS) {
+        descriptionError("The output formats hold 12-bit words only", NULL);
+    }
+    for (i = 0; i < fieldsSize; i++) {
+        if (fields[i].width <= 0) {
+            descriptionError("Missing field", fields[i].name);
+        }
+        if (fields[i].shift < 0 ||
+            fields[i].shift + fields[i].width > wordBits) {
+            descriptionError("The field doesn't fit in a word", fields[i].name);
+        }
+    }
+    for (i = 0; i < modesSize; i++) {
+        if (modes[i].code == -1) {
+            descriptionError("Missing mode", modes[i].name);
+        }
+        checkFits(modes[i].code, "source", modes[i].name);
+        checkFits(modes[i].code, "target", modes[i].name);
+    }
+    for (i = 0; i < aresSize; i++) {
+        if (ares[i].code == -1) {
+            descriptionError("Missing ARE bits", ares[i].name);
+        }
+        checkFits(ares[i].code, "are", ares[i].name);
+    }
+    for (i = 0; i < registersSize; i++) {
+        checkFits(registers[i].number, "source_register", registers[i].name);
+        checkFits(registers[i].number, "target_register", registers[i].name);
+    }
+    for (i = 0; i < commandsSize; i++) {
+        checkFits(commands[i].opcode, "opcode", commands[i].mnemonic);
+    }
+    if (commandsSize == 0) {
+        descriptionError("No commands are described", NULL);
+    }
+}
+
+/******************************************************************************/
+/**
+ * Finds the smallest collision-free hash table of the mnemonics.
+ *
+ * @param hashTable - Filled with the index of the command of each slot, or -1.
+ * @param multiplier - Set to the multiplier of the hash.
+ * @return The size of the hash table.
+ */
+unsigned long buildHashTable(int *hashTable, unsigned long *multiplier) {
+    unsigned long size, slot;
+    int i;
+
+    for (size = 1; size < (unsigned long) commandsSize * 2; size <<= 1);
+    for (; size <= MAX_HASH_SIZE; size <<= 1) {
+        for (*multiplier = 2; *multiplier < 256; (*multiplier)++) {
+            for (slot = 0; slot < size; slot++) {
+                hashTable[slot] = -1;
+            }
+            for (i = 0; i < commandsSize; i++) {
+                slot = hashMnemonic(commands[i].mnemonic, *multiplier, size);
+                if (hashTable[slot] != -1) {
+                    break;
+                }
+                hashTable[slot] = i;
+            }
+            if (i == commandsSize) {
+                return size;
+            }
+        }
+    }
+    descriptionError("No collision-free hash of the mnemonics was found", NULL);
+    return 0;
+}
+
+/******************************************************************************/
+/**
+ * Writes the generated header.
+ *
+ * @param out - The header file.
+ */
+void writeTables(FILE *out) {
+    int hashTable[MAX_HASH_SIZE];
+    unsigned long hashSize, multiplier, slot;
+    int i, params;
+    Field *opcode = &fields[findField("opcode")];
+
+    hashSize = buildHashTable(hashTable, &multiplier);
+
+    fprintf(out, "/* isa_tables.h - Generated by isa_gen from %s, do not edit."
+                 " */\n\n", descriptionFile);
+    fprintf(out, "#ifndef MAMAN14_ISA_TABLES_H\n#define MAMAN14_ISA_TABLES_H\n\n");
+
+    fprintf(out, "/* The bit fields of the words */\n");
+    fprintf(out, "#define ISA_WORD_BITS %d\n", wordBits);
+    for (i = 0; i < fieldsSize; i++) {
+        char upper[MAX_NAME_LENGTH];
+        int j;
+        for (j = 0; fields[i].name[j]; j++) {
+            upper[j] = (char) (fields[i].name[j] >= 'a' ?
+                               fields[i].name[j] - 'a' + 'A' :
+                               fields[i].name[j]);
+        }
+        upper[j] = '\0';
+        fprintf(out, "#define ISA_%s_SHIFT %d\n", upper, fields[i].shift);
+        fprintf(out, "#define ISA_%s_MASK 0x%X\n", upper,
+                (1 << fields[i].width) - 1);
+    }
+
+    fprintf(out, "\n/* The codes of the addressing modes and ARE bits */\n");
+    fprintf(out, "#define ISA_MODE_NUMBER %d\n", modes[0].code);
+    fprintf(out, "#define ISA_MODE_LABEL %d\n", modes[1].code);
+    fprintf(out, "#define ISA_MODE_REGISTER %d\n", modes[2].code);
+    fprintf(out, "#define ISA_ARE_ABSOLUTE %d\n", ares[0].code);
+    fprintf(out, "#define ISA_ARE_EXTERNAL %d\n", ares[1].code);
+    fprintf(out, "#define ISA_ARE_RELOCATABLE %d\n", ares[2].code);
+
+    fprintf(out, "\n/* The mnemonic hash table: hash = hash * MULTIPLIER + c "
+                 "over the characters,\n * masked by SIZE - 1 */\n");
+    fprintf(out, "#define ISA_COMMAND_HASH_MULTIPLIER %luUL\n", multiplier);
+    fprintf(out, "#define ISA_COMMAND_HASH_SIZE %lu\n\n", hashSize);
+
+    fprintf(out, "/* Lists of supported commands and registers */\n");
+    fprintf(out, "static const char *commandsList[] = {");
+    for (i = 0; i < commandsSize; i++) {
+        fprintf(out, "%s\"%s\"", i ? ", " : "", commands[i].mnemonic);
+    }
+    fprintf(out, "};\nstatic const int commandsListSize = "
+                 "sizeof(commandsList) / sizeof(char *);\n\n");
+
+    fprintf(out, "static const char *registersList[] = {");
+    for (i = 0; i < registersSize; i++) {
+        fprintf(out, "%s\"%s\"", i ? ", " : "", registers[i].name);
+    }
+    fprintf(out, "};\nstatic const int registersListSize = "
+                 "sizeof(registersList) / sizeof(char *);\n\n");
+
+    fprintf(out, "/* The number of each register */\n");
+    fprintf(out, "static const int registerNumbers[] = {");
+    for (i = 0; i < registersSize; i++) {
+        fprintf(out, "%s%d", i ? ", " : "", registers[i].number);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "/* The index of the command of each slot of the mnemonic "
+                 "hash table, or -1 */\n");
+    fprintf(out, "static const signed char commandHash[ISA_COMMAND_HASH_SIZE]"
+                 " = {");
+    for (slot = 0; slot < hashSize; slot++) {
+        fprintf(out, "%s%s%d", slot ? "," : "", slot % 16 ? " " : "\n        ",
+                hashTable[slot]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "/* Specification of the operand types for each command */\n");
+    fprintf(out, "static const OperandType operandTypes[][2] = {\n");
+    for (i = 0; i < commandsSize; i++) {
+        fprintf(out, "        {%s, %s}%s /* %s */\n",
+                operandTypeNames[commands[i].sourceModes],
+                operandTypeNames[commands[i].targetModes],
+                i + 1 < commandsSize ? "," : "", commands[i].mnemonic);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "/* Specification of the number of parameters for each "
+                 "command */\n");
+    fprintf(out, "static const int paramCount[] = {\n");
+    for (i = 0; i < commandsSize; i++) {
+        params = (commands[i].sourceModes != 0) +
+                 (commands[i].targetModes != 0);
+        fprintf(out, "        %d%s /* %s */\n", params,
+                i + 1 < commandsSize ? "," : "", commands[i].mnemonic);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "/* The words of each command: the command word and a word "
+                 "for each operand.\n * Two register operands share a "
+                 "word, so the decoder counts one less for them. */\n");
+    fprintf(out, "static const int commandWordCount[] = {\n");
+    for (i = 0; i < commandsSize; i++) {
+        params = (commands[i].sourceModes != 0) +
+                 (commands[i].targetModes != 0);
+        fprintf(out, "        %d%s /* %s */\n", 1 + params,
+                i + 1 < commandsSize ? "," : "", commands[i].mnemonic);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "/* The command word of each command with its opcode and "
+                 "absolute ARE bits,\n * the addressing modes are added to it"
+                 " */\n");
+    fprintf(out, "static const unsigned short commandTemplates[] = {\n");
+    for (i = 0; i < commandsSize; i++) {
+        fprintf(out, "        0x%03X%s /* %s */\n",
+                (commands[i].opcode << opcode->shift) |
+                (ares[0].code << fields[findField("are")].shift),
+                i + 1 < commandsSize ? "," : "", commands[i].mnemonic);
+    }
+    fprintf(out, "};\n\n#endif\n");
+}
+
+/******************************************************************************/
+int main(int argc, char *argv[]) {
+    char line[MAX_DESCRIPTION_LINE];
+    char *comment;
+    FILE *in, *out;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <description file> <output header>\n",
+                argv[0]);
+        return 1;
+    }
+    descriptionFile = argv[1];
+    in = fopen(descriptionFile, "r");
+    if (in == NULL) {
+        fprintf(stderr, "isa_gen: Couldn't open %s\n", descriptionFile);
+        return 1;
+    }
+    while (fgets(line, sizeof(line), in) != NULL) {
+        descriptionLine++;
+        comment = strchr(line, '#');
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+        parseDescriptionLine(line);
+    }
+    fclose(in);
+    checkDescription();
+
+    out = fopen(argv[2], "w");
+    if (out == NULL) {
+        fprintf(stderr, "isa_gen: Couldn't create %s\n", argv[2]);
+        return 1;
+    }
+    writeTables(out);
+    fclose(out);
+    return 0;
+}
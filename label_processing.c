@@ -6,8 +6,8 @@
 * Description:          This file contains a set of functions related to processing
 *                       labels in an assembly language program.
 *                       This includes checking labels for syntax and logical errors,
-*                       updating lines in the program, writing labels to files,
-*                       and adding external labels to the program state.
+*                       patching the words referring to labels, writing labels to
+*                       files, and adding external labels to the program state.
 \******************************************************************************/
 
 
@@ -20,315 +20,381 @@
 #include "label_processing.h"
 #include "param_validation.h"
 #include "print_error.h"
+#include "line_tokenizer.h"
+#include "stats.h"
 
 /**************************** Forward Declarations ****************************/
 void addExternalLabel(int labelIdx, int lineNumber, ProgramState *programState);
+Status checkDuplicateLabel(const char *name, int line_number,
+                           ProgramState *programState);
 
 /************************* Functions  Implementations *************************/
+DEFINE_TYPED_VECTOR(LabelVector, Label, label_vector)
+/******************************************************************************/
+/**
+ * Adds a label to the labels of the program, and to their index.
+ *
+ * @param label A pointer to the label to add, copied into the labels.
+ * @param programState A pointer to the current state of the program.
+ */
+void AddLabel(const Label *label, ProgramState *programState) {
+    name_index_insert(&programState->labelIndex,
+                      name_hash(label->name, strlen(label->name)),
+                      programState->labels.size);
+    label_vector_push(&programState->labels, *label);
+}
+/******************************************************************************/
 /**
- * This function checks labels in an AM assembly code file. It validates label
+ * Checks that a label isn't already defined or declared extern, printing an
+ * error for each label with the same name.
+ *
+ * @param name The name of the label.
+ * @param line_number The number of the line defining the label.
+ * @param programState A pointer to the current state of the program.
+ *
+ * @return FAILURE if the label already exists, SUCCESS otherwise.
+ */
+Status checkDuplicateLabel(const char *name, int line_number,
+                           ProgramState *programState) {
+    unsigned long hash = name_hash(name, strlen(name));
+    int slot = name_index_start(&programState->labelIndex, hash);
+    int i;
+    Status ret = SUCCESS;
+
+    STATS_COUNT(STAT_SYMBOL_LOOKUPS);
+    while ((i = name_index_next(&programState->labelIndex, hash,
+                                &slot)) != -1) {
+        STATS_COUNT(STAT_STRING_COMPARISONS);
+        if (strcmp(name, programState->labels.items[i].name) == 0) {
+            PrintLabelErrorMessage(line_number, DUPLICATE_LABEL, name);
+            ret = FAILURE;
+        }
+    }
+    return ret;
+}
+/******************************************************************************/
+/**
+ * This function checks labels in the .am lines of the program. It validates label
  * format, uniqueness, and adherence to reserved words, while collecting
  * information about labels in the ProgramState structure.
  *
- * @param am_file_name The name of the assembly code file to check.
  * @param programState A pointer to the current state of the program.
  *
  * @return Status indicating success or failure of the operation.
  */
-Status checkLabels(char *am_file_name, ProgramState *programState) {
-    int i = 0, len = 0; /* Variables used for iterations and string length */
+Status checkLabels(ProgramState *programState) {
     int line_number = 0; /* Current line number in the AM assembly code file */
+    TokenizedLine *tokenizedLine = NULL; /* The current line of the AM assembly code file */
+    Status ret = SUCCESS; /* Return status, set to SUCCESS initially and changes on error occurrence */
+
+    /* First scan to validate and collect labels */
+    for (line_number = 1;
+         line_number <= programState->amLines->size; line_number++) {
+        tokenizedLine = programState->amLines->items[line_number - 1];
+        SetErrorOrigin(tokenizedLine->origin_file, tokenizedLine->origin_line);
+        if (checkLabel(tokenizedLine->text, line_number, programState) !=
+            SUCCESS) {
+            ret = FAILURE;
+        }
+        if (ErrorLimitReached()) {
+            break;
+        }
+    }
+    SetErrorOrigin(NULL, 0);
+
+    return ret;
+}
+/******************************************************************************/
+/**
+ * This function checks the label defined by a single line of the .am file,
+ * either as the line's label or by an '.extern' instruction, and adds it to
+ * the labels of the ProgramState structure.
+ *
+ * @param line The text of the line.
+ * @param line_number The line number in the .am file.
+ * @param programState A pointer to the current state of the program.
+ *
+ * @return Status indicating success or failure of the operation.
+ */
+Status checkLabel(const char *line, int line_number,
+                  ProgramState *programState) {
+    int i = 0, len = 0; /* Variables used for iterations and string length */
     int label_length = -1; /* Length of the currently processed label */
 
-    char line[MAX_LINE_LENGTH] = {
-            0}; /* Buffer to store each line of the AM assembly code file */
     char new_label[MAX_LABEL_LENGTH] = {
             0}; /* Buffer to store the label to be processed */
-    char *label_end = NULL; /* Pointer to mark the end of a label in the line buffer */
+    const char *label_end = NULL; /* Pointer to mark the end of a label in the line buffer */
 
-    Label *newLabel = NULL; /* Pointer to a new Label structure to be created */
+    Label newLabel; /* The new Label structure to be added */
 
     Status ret = SUCCESS; /* Return status, set to SUCCESS initially and changes on error occurrence */
 
-    FILE *file = fopen(am_file_name, "r"); /* Open the AM assembly code file */
-
-    if (!file) {
-        printf("File not found: %s\n", am_file_name);
-        return FAILURE;
-    }
+    /* Check if line starts with a label */
+    label_end = strchr(line, ':');
+    if (label_end) {
+        /* Extract label */
+        label_length = (int) (label_end - line);
+        /* Check if label length is less than 31, a longer one isn't
+         * checked any further, it doesn't fit in the label buffers */
+        if (label_length >= MAX_LABEL_LENGTH) {
+            PrintLabelErrorMessage(line_number, LABEL_LENGTH_EXCEEDS_LIMIT,
+                                   NULL);
+            return FAILURE;
+        }
 
-    /* First scan to validate and collect labels */
-    while (fgets(line, sizeof(line), file)) {
-        line_number++;
+        /* Check if label is a saved word */
+        strncpy(new_label, line, label_length);
+        new_label[label_length] = '\0';
+        to_lowercase(new_label);
 
-        /* Check if line starts with a label */
-        label_end = strchr(line, ':');
-        if (label_end) {
-            /* Extract label */
-            label_length = (int) (label_end - line);
-            /* Check if label length is less than 31 */
-            if (label_length >= MAX_LABEL_LENGTH) {
-                PrintLabelErrorMessage(line_number, LABEL_LENGTH_EXCEEDS_LIMIT,
-                                       NULL);
-                ret = FAILURE;
+        if (lookupCommand(new_label) != -1) {
+            PrintLabelErrorMessage(line_number,
+                                   LABEL_IS_RESERVED_COMMAND_WORD,
+                                   new_label);
+            ret = FAILURE;
+        }
+        /* If the label starts with a '.', it might be a reserved instruction word */
+        if (new_label[0] == '.') {
+            /* Remove the '.' from the beginning of the label by shifting the string to the left */
+            len = strlen(new_label);
+            for (i = 0; i < len; i++) {
+                new_label[i] = new_label[i + 1];
             }
 
-            /* Check if label is a saved word */
-            strncpy(new_label, line, label_length);
-            new_label[label_length] = '\0';
-            to_lowercase(new_label);
-
-            for (i = 0; i < commandsListSize; i++) {
-                if (strcmp(new_label, commandsList[i]) == 0) {
+            /* Loop through all instruction words to check if the label is a reserved instruction word */
+            for (i = 0; i < instructionsListSize; i++) {
+                /* If the label matches a reserved instruction word */
+                if (strcmp(new_label, instructionsList[i]) == 0) {
+                    /* Print error message and set the return status to FAILURE */
                     PrintLabelErrorMessage(line_number,
-                                           LABEL_IS_RESERVED_COMMAND_WORD,
+                                           LABEL_IS_RESERVED_INSTRUCTION_WORD,
                                            new_label);
                     ret = FAILURE;
                 }
             }
-            /* If the label starts with a '.', it might be a reserved instruction word */
-            if (new_label[0] == '.') {
-                /* Remove the '.' from the beginning of the label by shifting the string to the left */
-                len = strlen(new_label);
-                for (i = 0; i < len; i++) {
-                    new_label[i] = new_label[i + 1];
-                }
-
-                /* Loop through all instruction words to check if the label is a reserved instruction word */
-                for (i = 0; i < instructionsListSize; i++) {
-                    /* If the label matches a reserved instruction word */
-                    if (strcmp(new_label, instructionsList[i]) == 0) {
-                        /* Print error message and set the return status to FAILURE */
-                        PrintLabelErrorMessage(line_number,
-                                               LABEL_IS_RESERVED_INSTRUCTION_WORD,
-                                               new_label);
-                        ret = FAILURE;
-                    }
-                }
-            }
-            /* If the label starts with an '@', it might be a reserved register word */
-            if (new_label[0] == '@') {
-                /* Remove the '@' from the beginning of the label */
-                strcpy(new_label, new_label + 1);
-
-                /* Loop through all register words to check if the label is a reserved register word */
-                for (i = 0; i < registersListSize; i++) {
-                    /* If the label matches a reserved register word */
-                    if (strcmp(new_label, registersList[i]) == 0) {
-                        /* Print error message and set the return status to FAILURE */
-                        PrintLabelErrorMessage(line_number,
-                                               LABEL_IS_RESERVED_REGISTER_WORD,
-                                               new_label);
-                        ret = FAILURE;
-                    }
-                }
-            }
-
-            /* Check if label contains spaces */
-            for (i = 0; i < label_length; i++) {
-                if (isspace(line[i])) {
-                    PrintLabelErrorMessage(line_number, INVALID_LABEL_FORMAT,
+        }
+        /* If the label starts with an '@', it might be a reserved register word */
+        if (new_label[0] == '@') {
+            /* Remove the '@' from the beginning of the label */
+            memmove(new_label, new_label + 1, strlen(new_label));
+
+            /* Loop through all register words to check if the label is a reserved register word */
+            for (i = 0; i < registersListSize; i++) {
+                /* If the label matches a reserved register word */
+                if (strcmp(new_label, registersList[i]) == 0) {
+                    /* Print error message and set the return status to FAILURE */
+                    PrintLabelErrorMessage(line_number,
+                                           LABEL_IS_RESERVED_REGISTER_WORD,
                                            new_label);
                     ret = FAILURE;
                 }
             }
+        }
 
-            /* Check if the first character is a letter */
-            if (!isalpha(new_label[0])) {
-                PrintLabelErrorMessage(line_number,
-                                       LABEL_MUST_START_WITH_LETTER, new_label);
+        /* Check if label contains spaces */
+        for (i = 0; i < label_length; i++) {
+            if (isspace(line[i])) {
+                PrintLabelErrorMessage(line_number, INVALID_LABEL_FORMAT,
+                                       new_label);
                 ret = FAILURE;
             }
+        }
 
-            /* Check for duplicate labels */
-            strncpy(new_label, line, label_length);
-            new_label[label_length] = '\0';
-            for (i = 0; i < programState->labels->size; i++) {
-                Label *existingLabel = (Label *) programState->labels->items[i];
-                if (strcmp(new_label, existingLabel->name) == 0) {
-                    PrintLabelErrorMessage(line_number, DUPLICATE_LABEL,
-                                           new_label);
-                    ret = FAILURE;
-                }
+        /* Check if the first character is a letter */
+        if (!isalpha(new_label[0])) {
+            PrintLabelErrorMessage(line_number,
+                                   LABEL_MUST_START_WITH_LETTER, new_label);
+            ret = FAILURE;
+        }
+
+        /* Check for duplicate labels */
+        strncpy(new_label, line, label_length);
+        new_label[label_length] = '\0';
+        if (checkDuplicateLabel(new_label, line_number,
+                                programState) == FAILURE) {
+            ret = FAILURE;
+        }
+        strncpy(newLabel.name, new_label, label_length + 1);
+        newLabel.line_number = line_number;
+        newLabel.asm_line_number = 0; /* Set when the line is encoded */
+        newLabel.isData = 0;
+        newLabel.isEntry = 0;
+        newLabel.isExtern = 0;
+        AddLabel(&newLabel, programState);
+    } else {
+        /* Check if line starts with an 'extern' instruction */
+        if (startsWith(line, ".extern")) {
+            /* Extract label */
+            const char *label_start = line + strlen(".extern") +
+                                1; /* +1 to skip the space after '.extern' */
+            label_end = strpbrk(label_start,
+                                " \t\n"); /* find the end of the label */
+            if (!label_end)
+                label_end = label_start +
+                            strlen(label_start); /* end of string if no whitespace found */
+
+            /* Check and add the label as before, but mark it as extern */
+            label_length = (int) (label_end - label_start);
+            if (label_length >= MAX_LABEL_LENGTH) {
+                PrintLabelErrorMessage(line_number, LABEL_LENGTH_EXCEEDS_LIMIT,
+                                       NULL);
+                return FAILURE;
             }
-            newLabel = malloc(sizeof(Label));
-            strncpy(newLabel->name, new_label, label_length + 1);
-            newLabel->line_number = line_number;
-            newLabel->isEntry = 0;
-            newLabel->isExtern = 0;
-            push_back(programState->labels, newLabel);
-        } else {
-            /* Check if line starts with an 'extern' instruction */
-            if (startsWith(line, ".extern")) {
-                /* Extract label */
-                char *label_start = line + strlen(".extern") +
-                                    1; /* +1 to skip the space after '.extern' */
-                label_end = strpbrk(label_start,
-                                    " \t\n"); /* find the end of the label */
-                if (!label_end)
-                    label_end = label_start +
-                                strlen(label_start); /* end of string if no whitespace found */
-
-                /* Check and add the label as before, but mark it as extern */
-                label_length = (int) (label_end - label_start);
-                strncpy(new_label, label_start, label_length);
-                new_label[label_length] = '\0';
-
-                /* Check for duplicate labels */
-                for (i = 0; i < programState->labels->size; i++) {
-                    Label *existingLabel = programState->labels->items[i];
-                    if (strcmp(new_label, existingLabel->name) == 0) {
-                        PrintLabelErrorMessage(line_number, DUPLICATE_LABEL,
-                                               new_label);
-                        ret = FAILURE;
-                    }
-                }
+            strncpy(new_label, label_start, label_length);
+            new_label[label_length] = '\0';
 
-                newLabel = malloc(sizeof(Label));
-                strncpy(newLabel->name, new_label, label_length + 1);
-                newLabel->line_number = -1; /* No line number for extern labels */
-                newLabel->isEntry = 0;
-                newLabel->isExtern = 1;
-                push_back(programState->labels, newLabel);
+            /* Check for duplicate labels */
+            if (checkDuplicateLabel(new_label, line_number,
+                                    programState) == FAILURE) {
+                ret = FAILURE;
             }
+
+            strncpy(newLabel.name, new_label, label_length + 1);
+            newLabel.line_number = -1; /* No line number for extern labels */
+            newLabel.asm_line_number = 0;
+            newLabel.isData = 0;
+            newLabel.isEntry = 0;
+            newLabel.isExtern = 1;
+            AddLabel(&newLabel, programState);
         }
     }
 
-    fclose(file);
     return ret;
 }
 /******************************************************************************/
 /**
- * Updates program state by examining each line of an assembly language file.
+ * Sets the address of a label, once the line defining it is reached.
  *
- * This function handles the processing of command lines and instructions,
- * taking into account whether a label is present. It validates the
- * parameters for the command or instruction, handles labels as required, and
- * updates the program state accordingly.
+ * @param name The label defined by the line.
+ * @param address The address of the first word of the line. For a data line,
+ *                its offset in the data image, rebased by ResolveFixups.
+ * @param isData Whether the line is a data line.
+ * @param programState A pointer to the current state of the program.
+ */
+void SetLabelAddress(const char *name, int address, int isData,
+                     ProgramState *programState) {
+    int labelIdx = getLabelIndex(name, programState);
+    Label *label = NULL;
+    if (labelIdx != -1) {
+        label = &programState->labels.items[labelIdx];
+        label->asm_line_number = address;
+        label->isData = isData;
+    }
+}
+/******************************************************************************/
+/**
+ * Patches the words referring to labels, once all the labels and their
+ * addresses are known. The data is loaded right after the code, so the data
+ * labels are first rebased by the final size of the code.
+ * A word referring to an external label is encoded as external, and its
+ * address is added to the external labels of the program.
+ * In one-pass mode, the '.entry' directives are checked here as well.
  *
- * @param words A list of words parsed from a line in the assembly language file.
- * @param num_of_words The number of words in the list.
- * @param has_label Flag indicating if the line has a label.
  * @param programState A pointer to the current state of the program.
+ *
+ * @return Status indicating success or failure of the operation.
  */
-void UpdateLines(char *words[], int num_of_words, int has_label,
-                 ProgramState *programState) {
-    /* Pointer to the current program state */
-    ProgramState *currentProgramState = programState;
-
-    /* Variables for indexing and storing label, command, and operand details */
-    int i, commandIdx, commandOrderInWords, operandIdx;
-    char *command;
-    int labelIdx;
+Status ResolveFixups(ProgramState *programState) {
+    int i, labelIdx;
+    Fixup *fixup = NULL;
     Label *label = NULL;
+    Status ret = SUCCESS;
 
-    /* If a label is present, the command is the second word. Otherwise, it's the first word */
-    if (has_label) {
-        commandOrderInWords = 1;
-    } else {
-        commandOrderInWords = 0;
+    for (i = 0; i < programState->labels.size; i++) {
+        label = &programState->labels.items[i];
+        if (label->isData) {
+            label->asm_line_number += START_ADDRESS + programState->code->size;
+        }
     }
 
-    /* Store the command for processing */
-    command = words[commandOrderInWords];
-    /* Find the index of the command */
-    commandIdx = findCommand(command);
-
-    /* If a label is present, find it and update its line number */
-    if (has_label) {
-        for (i = 0; i < currentProgramState->labels->size; i++) {
-            label = (Label *) currentProgramState->labels->items[i];
-            if (strcmp(words[0], label->name) == 0) {
-                label->asm_line_number = currentProgramState->current_line_number;
-                break;
+    for (i = 0; i < programState->fixups->size && !ErrorLimitReached(); i++) {
+        fixup = (Fixup *) programState->fixups->items[i];
+        SetErrorOrigin(fixup->origin_file, fixup->origin_line);
+        labelIdx = getLabelIndex(fixup->name, programState);
+        label = labelIdx != -1 ? &programState->labels.items[labelIdx]
+                               : NULL;
+        fixup->label_index = labelIdx;
+
+        if (fixup->slot == -1) {
+            /* An '.entry' directive, the label must be defined in the file */
+            if (label == NULL || label->isExtern) {
+                PrintLabelErrorMessage(fixup->line_number,
+                                       ENTRY_REQUIRES_EXISTING_LABEL,
+                                       fixup->name);
+                ret = FAILURE;
+            } else {
+                label->isEntry = 1;
             }
+        } else if (label == NULL) {
+            PrintLabelErrorMessage(fixup->line_number, LABEL_DOES_NOT_EXIST,
+                                   fixup->name);
+            ret = FAILURE;
+        } else if (label->isExtern) {
+            /* Address 0 with the "01" external ARE bits */
+            programState->code->words[fixup->slot] =
+                    ISA_ARE_EXTERNAL << ISA_ARE_SHIFT;
+            addExternalLabel(labelIdx, START_ADDRESS + fixup->slot,
+                             programState);
+        } else {
+            /* The label's address with the "10" relocatable ARE bits */
+            programState->code->words[fixup->slot] = (unsigned short)
+                    (((label->asm_line_number & ISA_VALUE_MASK) <<
+                      ISA_VALUE_SHIFT) |
+                     (ISA_ARE_RELOCATABLE << ISA_ARE_SHIFT));
         }
     }
+    SetErrorOrigin(NULL, 0);
 
-    /* Check if it's a command and not an instruction */
-    if (commandIdx != -1) {
-        /* Not enough parameters for the command, do nothing */
-        if (num_of_words <= commandOrderInWords + paramCount[commandIdx]) {
-            return; /* not enough parameters for the command */
-        }
-        /* Iterate over all the operands */
-        for (operandIdx = commandOrderInWords + 1; operandIdx <=
-                                                   commandOrderInWords +
-                                                   paramCount[commandIdx]; operandIdx++) {
-            /* If operand is a label */
-            if (isLabel(words[operandIdx], currentProgramState)) {
-                /* Find the index of label in program state */
-                labelIdx = getLabelIndex(words[operandIdx],
-                                         currentProgramState);
-                label = (Label *) currentProgramState->labels->items[labelIdx];
-                /* If label is external */
-                if (label->isExtern) {
-                    /* Calculate line number offset depending on label presence */
-                    if (has_label) {
-                        if (operandIdx == 2) {
-                            addExternalLabel(labelIdx,
-                                             currentProgramState->current_line_number +
-                                             1, currentProgramState);
-                        } else {
-                            addExternalLabel(labelIdx,
-                                             currentProgramState->current_line_number +
-                                             2, currentProgramState);
-                        }
-                    } else {
-                        if (operandIdx == 1) {
-                            addExternalLabel(labelIdx,
-                                             currentProgramState->current_line_number +
-                                             1, currentProgramState);
-                        } else {
-                            addExternalLabel(labelIdx,
-                                             currentProgramState->current_line_number +
-                                             2, currentProgramState);
-                        }
-                    }
-                }
-            }
-        }
-        /* Update current line number */
-        currentProgramState->current_line_number +=
-                paramCount[commandIdx] + 1;
-        /* If both parameters are registers, we decrement the line count by 1 */
-        if (paramCount[commandIdx] == 2 &&
-            isValidParam(words[commandOrderInWords + 1],
-                         OPERAND_TYPE_REGISTER, currentProgramState) &&
-            isValidParam(words[commandOrderInWords + 2],
-                         OPERAND_TYPE_REGISTER, currentProgramState)) {
-            currentProgramState->current_line_number--;
-        }
-    } else { /* It's an instruction */
-        if (strcmp(command, "string") == 0) {
-            if (has_label) {
-                /* Not enough parameters for the instruction, do nothing */
-                if (num_of_words < 3) {
-                    return;
-                }
-            } else {
-                if (num_of_words < 2) {
-                    return; /* not enough parameters for the instruction */
-                }
+    return ret;
+}
+/******************************************************************************/
+/**
+ * Checks that the labels the decoded statements refer to exist, without
+ * encoding them: reports the same errors as ResolveFixups, in the same order,
+ * when the file is only checked (--check) or already has errors, so its words
+ * would be thrown away.
+ *
+ * @param programState A pointer to the current state of the program.
+ *
+ * @return Status indicating whether all the labels referred to exist.
+ */
+Status CheckReferences(ProgramState *programState) {
+    int i, j, labelIdx;
+    const Statement *statement = NULL;
+    Status ret = SUCCESS;
+
+    for (i = 0; i < programState->statements.size && !ErrorLimitReached();
+         i++) {
+        statement = &programState->statements.items[i];
+        SetErrorOrigin(statement->source->origin_file,
+                       statement->source->origin_line);
+        if (statement->kind == STATEMENT_ENTRY) {
+            /* An '.entry' directive, the label must be defined in the file */
+            labelIdx = getLabelIndex(statement->operands[0].value.symbol,
+                                     programState);
+            if (labelIdx == -1 ||
+                programState->labels.items[labelIdx].isExtern) {
+                PrintLabelErrorMessage(statement->line_number,
+                                       ENTRY_REQUIRES_EXISTING_LABEL,
+                                       statement->operands[0].value.symbol);
+                ret = FAILURE;
             }
-            /* Including the null character at the end of the string */
-            currentProgramState->current_line_number +=
-                    strlen(words[commandOrderInWords + 1]) + 1;
-        } else if (strcmp(command, "data") == 0) {
-            /* Increment line number according to the number of parameters */
-            if (has_label) {
-                if (num_of_words < 3) {
-                    return; /* not enough parameters for the instruction */
-                }
-                currentProgramState->current_line_number += num_of_words - 2;
-            } else {
-                if (num_of_words < 2) {
-                    return; /* not enough parameters for the instruction */
+        } else if (statement->kind == STATEMENT_COMMAND) {
+            for (j = 0; j < 2; j++) {
+                if (statement->operands[j].mode == LABEL &&
+                    getLabelIndex(statement->operands[j].value.symbol,
+                                  programState) == -1) {
+                    PrintLabelErrorMessage(statement->line_number,
+                                           LABEL_DOES_NOT_EXIST,
+                                           statement->operands[j].value.symbol);
+                    ret = FAILURE;
                 }
-                currentProgramState->current_line_number += num_of_words - 1;
             }
         }
     }
+    SetErrorOrigin(NULL, 0);
+
+    return ret;
 }
 
 /******************************************************************************/
@@ -352,7 +418,7 @@ void WriteLabelsToFile(const char *ent_filename, const char *ext_filename,
     Label *externalLabel = NULL;
     ProgramState *currentProgramState = programState;
 
-    for (i = 0; i < currentProgramState->externalLabels->size; i++) {
+    for (i = 0; i < currentProgramState->externalLabels.size; i++) {
         if (extern_fp == NULL) {
             extern_fp = fopen(ext_filename, "w");
             if (extern_fp == NULL) {
@@ -361,14 +427,14 @@ void WriteLabelsToFile(const char *ent_filename, const char *ext_filename,
                 return;
             }
         }
-        externalLabel = (Label *) currentProgramState->externalLabels->items[i];
+        externalLabel = &currentProgramState->externalLabels.items[i];
         fprintf(extern_fp, "%s %d\n",
                 externalLabel->name,
                 externalLabel->asm_line_number);
     }
 
-    for (i = 0; i < currentProgramState->labels->size; i++) {
-        Label *label = (Label *) currentProgramState->labels->items[i];
+    for (i = 0; i < currentProgramState->labels.size; i++) {
+        Label *label = &currentProgramState->labels.items[i];
         if (label->isEntry) {
             if (entry_fp == NULL) {
                 entry_fp = fopen(ent_filename, "w");
@@ -388,9 +454,11 @@ void WriteLabelsToFile(const char *ent_filename, const char *ext_filename,
     }
 
     if (entry_fp != NULL) {
+        STATS_ADD(STAT_BYTES_WRITTEN, ftell(entry_fp));
         fclose(entry_fp);
     }
     if (extern_fp != NULL) {
+        STATS_ADD(STAT_BYTES_WRITTEN, ftell(extern_fp));
         fclose(extern_fp);
     }
 }
@@ -403,28 +471,18 @@ void WriteLabelsToFile(const char *ent_filename, const char *ext_filename,
  * @param lineNumber - line number to be assigned to the new label.
  * @param programState - the current state of the program.
  *
- * The function allocates a new Label object and copies data
- * from the existing label to the new label,
- * updates the line number in the new label,
- * and then adds this new label to the vector of external labels.
+ * The function copies the existing label into the vector of external labels,
+ * and updates the line number of the copy.
  */
 void
 addExternalLabel(int labelIdx, int lineNumber, ProgramState *programState) {
     Label *newLabel;
 
-    /* Copy the label to a new label object */
-    newLabel = malloc(sizeof(Label));
-    if (newLabel == NULL) {
-        /* Handle memory allocation error */
-        return;
-    }
-    /* Copy the data from the existing label in the vector to the new label */
-    memcpy(newLabel, programState->labels->items[labelIdx], sizeof(Label));
+    /* Copy the data from the existing label in the vector to a new label */
+    newLabel = label_vector_push(&programState->externalLabels,
+                                 programState->labels.items[labelIdx]);
 
     /* Update the line number */
     newLabel->asm_line_number = lineNumber;
-
-    /* Add the new label to the vector */
-    push_back(programState->externalLabels, newLabel);
 }
 /******************************************************************************/
@@ -4,8 +4,8 @@
 * Date:                  August-2023
 * Description:           This header file provides an interface for the label processing
 *                        functionality in an assembly language program. It contains the
-*                        function prototypes for checking labels, updating lines in
-*                        the program, writing labels to files, and adding external labels.
+*                        function prototypes for checking labels, patching the words
+*                        referring to them, and writing labels to files.
 \******************************************************************************/
 #ifndef MAMAN14_LABEL_PROCESSING_H
 #define MAMAN14_LABEL_PROCESSING_H
@@ -14,19 +14,45 @@
 #include "utils.h"
 
 /**
- * Checks all labels in the assembly file for syntax and logical errors.
+ * Adds a label to the labels of the program, and indexes it by its name.
+ * The function doesn't return a value.
+ */
+void AddLabel(const Label *label, ProgramState *programState);
+
+/**
+ * Checks all labels in the .am lines of the program for syntax and logical errors.
+ * Returns a Status indicating whether the operation was successful or not.
+ */
+Status checkLabels(ProgramState *programState);
+
+/**
+ * Checks the label defined by a single line of the .am file, and adds it to
+ * the labels of the program.
  * Returns a Status indicating whether the operation was successful or not.
  */
-Status checkLabels(char *am_file_name, ProgramState *programState);
+Status checkLabel(const char *line, int line_number,
+                  ProgramState *programState);
 
 /**
- * Processes labels and lines of assembly code to update line numbers and
- * corresponding label states in the program. This includes managing references to
- * labels and handling line adjustments for label usage.
+ * Sets the address of a label when the line defining it is encoded.
  * The function doesn't return a value.
  */
-void UpdateLines(char *words[], int num_of_words, int has_label,
-                 ProgramState *programState);
+void SetLabelAddress(const char *name, int address, int isData,
+                     ProgramState *programState);
+
+/**
+ * Patches the words referring to labels in the word image of the program, and
+ * collects the references to external labels.
+ * Returns a Status indicating whether all the labels referred to exist.
+ */
+Status ResolveFixups(ProgramState *programState);
+
+/**
+ * Checks that the labels referred to by the decoded statements exist, without
+ * encoding them, for a file that is only checked or already has errors.
+ * Returns a Status indicating whether all the labels referred to exist.
+ */
+Status CheckReferences(ProgramState *programState);
 
 /**
  * Writes all labels into entry and external files.
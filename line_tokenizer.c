@@ -0,0 +1,307 @@
+/*********************************FILE__HEADER*********************************\
+*
+* File:                 line_tokenizer.c
+* Authors:              Daniel Brodsky & Lior Katav
+* Date:                 August-2023
+* Description:          This file contains the function for splitting a line
+*                       of the .am file into its words.
+*                       It walks the line with a small state machine, records
+*                       comma errors instead of printing them and packs the
+*                       result into one allocation, so macro bodies can be
+*                       tokenized once and reused at every call site.
+*
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <string.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "line_tokenizer.h"
+#include "program_constants.h" /* for the State enum */
+
+/**************************** Forward Declarations ****************************/
+void addLineError(LineError *errors, int *num_of_errors, CommaErrorType type,
+                  char character);
+
+/************************* Functions  Implementations *************************/
+/**
+ * Splits a line into words, according to the current state of each character,
+ * and collects the comma errors found on the way.
+ *
+ * @param text - The line to tokenize, without leading spaces and newline.
+ * @param origin_file - The included file the line came from, or NULL.
+ * @param origin_line - The line number in origin_file.
+ * @param arena - The arena to allocate the TokenizedLine from.
+ *
+ * @return TokenizedLine - A pointer to a TokenizedLine allocated from the arena.
+ *                         The program exits if the allocation fails.
+ */
+TokenizedLine *tokenizeLine(const char *text, const char *origin_file,
+                            int origin_line, Arena *arena) {
+    /* Buffer to hold the line while it is split into words */
+    char buffer[MAX_SOURCE_LINE_LENGTH];
+
+    /* Array of words parsed from the line */
+    char *input_words[MAX_SOURCE_LINE_LENGTH / 2 + 1];
+
+    /* Comma errors found in the line */
+    LineError errors[MAX_SOURCE_LINE_LENGTH + 1];
+    int num_of_errors = 0;
+
+    /* The tokenized line and the cursor inside its single allocation */
+    TokenizedLine *tokenized = NULL;
+    char *block = NULL;
+
+    /* Number of words in the line, initialized to 0 */
+    int num_of_words = 0;
+
+    /* Loop counters */
+    int i = 0, j = 0;
+
+    /* Flag indicating if a label exists in the line, initialized to 0 (no label) */
+    int has_label = 0;
+
+    /* State of the line parser */
+    State state = IN_LABEL_OR_COMMAND;
+
+    /* Length of the line or word */
+    size_t len = strlen(text);
+    size_t text_len = 0, words_len = 0;
+
+    /* The last non-space character in the line, initialized to '\0' */
+    char last_non_space = '\0';
+
+    if (len >= sizeof(buffer)) {
+        len = sizeof(buffer) - 1;
+    }
+    text_len = len;
+
+    /* Skip quotes */
+    for (i = 0, j = 0; i < len; i++) {
+        if (text[i] != '"') {
+            buffer[j++] = text[i];
+        }
+    }
+    buffer[j] = '\0';
+    words_len = j;
+    input_words[num_of_words++] = buffer;
+
+    /* Parse the line according to its current state */
+    for (i = 0; buffer[i] != '\0'; i++) {
+        char c = buffer[i];
+        if (!isspace(c)) {
+            last_non_space = c;
+        }
+        /** This switch-case statement handles the parsing of each character in the line.
+        *  It operates on different states which correspond to the different parts of a line,
+        *  e.g., label, command, operand, etc.
+        *  The state changes based on the type of the current character (e.g., alnum, space, comma, etc.) and the current state.
+        *  The result of the parsing process is stored in input_words array.
+        */
+        switch (state) {
+            /* The IN_LABEL_OR_COMMAND state processes a part of the line that could either be a label or a command: */
+            case IN_LABEL_OR_COMMAND:
+                /** Check if the character is a space, a comma, or a colon.
+                *  If it's a space, mark the end of the current word and transition to AFTER_LABEL_OR_COMMAND state.
+                *  If it's a comma, handle it as an error since commas are not allowed in this context.
+                *  If it's a colon, mark that a label is present, mark the end of the label, and transition to AFTER_LABEL state.
+                */
+                if (isspace(c)) {
+                    buffer[i] = '\0';
+                    state = AFTER_LABEL_OR_COMMAND;
+                } else if (c == ',') {
+                    addLineError(errors, &num_of_errors, ILLEGAL_COMMA, ' ');
+                    continue;
+                } else if (c == ':') {
+                    has_label = 1;  /* Mark that a label is present */
+                    buffer[i] = '\0';
+                    state = AFTER_LABEL;
+                }
+                break;
+            case AFTER_LABEL:
+                /**
+                 * Check if we're in a command after a label. If so, add the command
+                 * to the input words. If we encounter a comma, it's an error because
+                 * commas are not expected directly after a label.
+                 */
+                if (isalnum(c)) {
+                    input_words[num_of_words++] = buffer + i;
+                    state = IN_COMMAND;
+                } else if (c == ',') {
+                    addLineError(errors, &num_of_errors, ILLEGAL_COMMA, ' ');
+                    continue;  /* Continue with next character */
+                }
+                break;
+                /* The AFTER_LABEL_OR_COMMAND state is entered after a label or command has been processed: */
+            case AFTER_LABEL_OR_COMMAND:
+                /** If a label has been identified and the character is alphanumeric, start a new word (command) and transition to IN_COMMAND state.
+                *  If a label has not been identified and the character is alphanumeric, or '@', '-', '+', start a new word (operand) and transition to IN_OPERAND state.
+                *  If the character is a comma, handle it as an error since commas are not allowed in this context.
+                */
+                if (has_label && isalnum(c)) {
+                    input_words[num_of_words++] = buffer + i;
+                    state = IN_COMMAND;
+                } else if (!has_label &&
+                           (isalnum(c) || c == '@' || c == '-' ||
+                            c == '+')) {
+                    input_words[num_of_words++] = buffer + i;
+                    state = IN_OPERAND;
+                } else if (c == ',') {
+                    addLineError(errors, &num_of_errors, ILLEGAL_COMMA, ' ');
+                    continue;  /* Continue with next character */
+                }
+                break;
+                /* The IN_COMMAND state processes the command part of the line (after a label): */
+            case IN_COMMAND:
+                /** If the character is a space, mark the end of the current word and transition to AFTER_COMMAND state.
+                *  If the character is a comma, handle it as an error since commas are not allowed in this context.
+                */
+                if (isspace(c)) {
+                    buffer[i] = '\0';
+                    state = AFTER_COMMAND;
+                } else if (c == ',') {
+                    addLineError(errors, &num_of_errors, ILLEGAL_COMMA, ' ');
+                    continue;
+                }
+                break;
+                /* The AFTER_COMMAND state is entered after a command has been processed: */
+            case AFTER_COMMAND:
+                /** If the character is alphanumeric, or '@', '-', '+', start a new word (operand) and transition to IN_OPERAND state.
+                *  If the character is a comma, handle it as an error since commas are not allowed in this context.
+                */
+                if (isalnum(c) || c == '-' || c == '+' || c == '@') {
+                    input_words[num_of_words++] = buffer + i;
+                    state = IN_OPERAND;
+                } else if (c == ',') {
+                    addLineError(errors, &num_of_errors, ILLEGAL_COMMA, ' ');
+                    continue;
+                }
+                break;
+                /* The IN_OPERAND state processes an operand part of the line: */
+            case IN_OPERAND:
+                /** If the character is a comma, mark the end of the current word and transition to AFTER_OPERAND_AND_WAITING state.
+                *  If the character is not alphanumeric, or '@', '-', '+', transition to EXPECTING_COMMA state.
+                */
+                if (c == ',') {
+                    if (!isspace(buffer[i - 1])) {
+                        buffer[i] = '\0';
+                    }
+                    state = AFTER_OPERAND_AND_WAITING;
+                } else if (!(isalnum(c) || c == '-' || c == '+' ||
+                             c == '@')) {
+                    state = EXPECTING_COMMA;
+                }
+                break;
+
+                /* The EXPECTING_COMMA state is entered when a comma is expected as a delimiter after an operand: */
+            case EXPECTING_COMMA:
+                /** If the character is alphanumeric, handle it as an error since a comma was expected, mark the end of the previous word, start a new word, and transition back to IN_OPERAND state.
+                *  If the character is a comma, mark the end of the current word and transition to AFTER_OPERAND state.
+                *  If the character is a space, ignore it and continue waiting for a comma.
+                */
+                if (isalnum(c)) {
+                    addLineError(errors, &num_of_errors, MISSING_COMMA, c);
+                    buffer[i - 1] = '\0';
+                    input_words[num_of_words++] = buffer + i;
+                    state = IN_OPERAND;
+                } else if (c == ',') {
+                    buffer[i] = '\0';
+                    state = AFTER_OPERAND;
+                } else if (isspace(c)) {
+                    continue;  /* Ignore spaces while expecting a comma */
+                }
+                break;
+
+                /* The AFTER_OPERAND_AND_WAITING state is entered after an operand has been processed and we are waiting for another operand or the end of the line: */
+            case AFTER_OPERAND_AND_WAITING:
+                /** If the character is alphanumeric, or '@', '-', '+', start a new word and transition back to IN_OPERAND state.
+                *  If the character is a comma, handle it as an error since consecutive commas are not allowed.
+                *  If the character is a space, ignore it and continue waiting for an alphanumeric character or a comma.
+                *  If the character is not alphanumeric, or '@', '-', '+', or a comma, transition to AFTER_OPERAND state.
+                */
+                if (isalnum(c) || c == '-' || c == '+' || c == '@') {
+                    input_words[num_of_words++] = buffer + i;
+                    state = IN_OPERAND;
+                } else if (c == ',') {
+                    addLineError(errors, &num_of_errors,
+                                 MULTIPLE_CONSECUTIVE_COMMAS, ' ');
+                    continue;
+                } else if (isspace(c)) {
+                    continue;
+                } else {
+                    state = AFTER_OPERAND;
+                }
+                break;
+                /* The AFTER_OPERAND state is entered after an operand has been processed: */
+            case AFTER_OPERAND:
+                /** If the character is alphanumeric, or '@', '-', '+', start a new word and transition back to IN_OPERAND state.
+                *  If the character is a comma, handle it as an error since consecutive commas are not allowed.
+                */
+                if (isalnum(c) || c == '-' || c == '+' || c == '@') {
+                    input_words[(num_of_words)++] = buffer + i;
+                    state = IN_OPERAND;
+                } else if (c == ',') {
+                    addLineError(errors, &num_of_errors,
+                                 MULTIPLE_CONSECUTIVE_COMMAS, ' ');
+                    continue;
+                }
+                break;
+        }
+    }
+    /* Trim trailing spaces from the operand */
+    for (i = num_of_words - 1; i >= 0; i--) {
+        len = strlen(input_words[i]);
+        while (len > 0 && isspace(input_words[i][len - 1])) {
+            input_words[i][len - 1] = '\0';
+            len--;
+        }
+    }
+    /* A comma at the end of the line is an error in the input format */
+    if (last_non_space == ',') {
+        addLineError(errors, &num_of_errors, EXTRA_COMMA_END_OF_LINE, ' ');
+    }
+
+    /* Pack the struct, the words, the errors and both copies of the line into one block */
+    tokenized = arena_alloc(arena, sizeof(TokenizedLine) +
+                                   (num_of_words + 1) * sizeof(char *) +
+                                   num_of_errors * sizeof(LineError) +
+                                   text_len + 1 + words_len + 1);
+    tokenized->words = (char **) (tokenized + 1);
+    tokenized->errors = (LineError *) (tokenized->words + num_of_words + 1);
+    tokenized->text = (char *) (tokenized->errors + num_of_errors);
+    block = tokenized->text + text_len + 1;
+
+    memcpy(tokenized->text, text, text_len);
+    tokenized->text[text_len] = '\0';
+    memcpy(block, buffer, words_len + 1);
+    for (i = 0; i < num_of_words; i++) {
+        tokenized->words[i] = block + (input_words[i] - buffer);
+    }
+    tokenized->words[num_of_words] = NULL;
+    memcpy(tokenized->errors, errors, num_of_errors * sizeof(LineError));
+
+    tokenized->origin_file = origin_file;
+    tokenized->origin_line = origin_line;
+    tokenized->num_of_words = num_of_words;
+    tokenized->has_label = has_label;
+    tokenized->num_of_errors = num_of_errors;
+    return tokenized;
+}
+/******************************************************************************/
+/**
+ * Records a comma error found while tokenizing a line.
+ *
+ * @param errors - The array of errors of the line.
+ * @param num_of_errors - Pointer to the number of errors recorded so far.
+ * @param type - The type of the comma error.
+ * @param character - The character that caused the error.
+ */
+void addLineError(LineError *errors, int *num_of_errors, CommaErrorType type,
+                  char character) {
+    errors[*num_of_errors].type = type;
+    errors[*num_of_errors].character = character;
+    (*num_of_errors)++;
+}
+/******************************************************************************/
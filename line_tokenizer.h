@@ -0,0 +1,56 @@
+/*********************************FILE__HEADER*********************************\
+* File:					line_tokenizer.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			This header file provides the interface for splitting
+*                       a single source line into its label, command and operand
+*                       words. A line is tokenized once and the result is shared
+*                       by every stage (and every macro call site) that needs it.
+\******************************************************************************/
+
+#ifndef MAMAN14_LINE_TOKENIZER_H
+#define MAMAN14_LINE_TOKENIZER_H
+
+#include "print_error.h" /* for the CommaErrorType enum */
+#include "arena.h" /* for the Arena struct */
+
+/* Maximum length of a raw source line, including the newline and '\0' */
+#define MAX_SOURCE_LINE_LENGTH 1024
+
+/**************************** Structs  Definitions ****************************/
+/* A comma error found while tokenizing, reported when the line is parsed */
+typedef struct {
+    CommaErrorType type;
+    char character;
+} LineError;
+
+/**
+ * A tokenized source line. The struct, its words, its errors and its text are
+ * kept in a single allocation from an arena, released with the arena.
+ */
+typedef struct {
+    char *text; /* The line as written to the .am file */
+    char **words; /* NULL terminated array of the words in the line */
+    LineError *errors; /* Comma errors found in the line */
+    const char *origin_file; /* The included file the line came from, or NULL */
+    int origin_line; /* The line number in origin_file */
+    int num_of_words;
+    int has_label;
+    int num_of_errors;
+} TokenizedLine;
+
+/******************************************************************************/
+/**
+ * Tokenizes a single line of assembly code.
+ *
+ * @param text - The line to tokenize, without leading spaces and newline.
+ * @param origin_file - The included file the line came from, or NULL for
+ *                      a line of the processed file itself.
+ * @param origin_line - The line number in origin_file.
+ * @param arena - The arena to allocate the TokenizedLine from.
+ * @return A pointer to the new TokenizedLine.
+ */
+TokenizedLine *tokenizeLine(const char *text, const char *origin_file,
+                            int origin_line, Arena *arena);
+
+#endif
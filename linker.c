@@ -0,0 +1,519 @@
+/*********************************FILE__HEADER*********************************\
+* File:                 linker.c
+* Authors:              Daniel Brodsky & Lior Katav
+* Date:                 August-2023
+* Description:          This file is a linker of modules assembled by the
+*                       assembler, separate from the assembler itself. Each
+*                       module is read from its .ob file, and from its .ent
+*                       and .ext files if it has them. The code of all the
+*                       modules is laid out consecutively from START_ADDRESS,
+*                       in the order they are given, followed by the data of
+*                       all the modules in the same order, and a single .ob
+*                       file of the linked program is written.
+*
+*                       The words referring to labels of their own module
+*                       (the relocatable ones) are moved by the new address
+*                       of the module's code or data. Each word listed in the
+*                       .ext file of a module is resolved through a hash
+*                       index of the entries of all the modules, and patched
+*                       with the address of the entry.
+*
+*                       Each module is read once, and each of its words and
+*                       symbols is visited a fixed number of times, so the
+*                       time grows linearly with the size of the modules.
+*
+*                       Usage: linker [--output <name>] <module1> ... <moduleN>
+*                       The modules are named without extensions, as given
+*                       to the assembler, and the program is written to
+*                       <name>.ob ("linked.ob" by default).
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "program_constants.h"
+#include "output_encoders.h"
+#include "typed_vector.h"
+#include "word_image.h"
+#include "name_index.h"
+#include "utils.h"
+
+/******************************** Definitions *********************************/
+/* The name of the linked program without the --output option */
+#define DEFAULT_OUTPUT_NAME "linked"
+
+/* The longest line of the files of a module: a label and an address */
+#define MAX_MODULE_LINE_LENGTH (MAX_LABEL_LENGTH + 16)
+
+/**************************** Structs  Definitions ****************************/
+/* A module: where its code and data are laid out in the linked program */
+typedef struct {
+    const char *name; /* The name of the module, without extensions */
+    int codeBase; /* The index of its first code word in the linked code */
+    int dataBase; /* The index of its first data word in the linked data */
+    int IC; /* The number of its code words */
+    int DC; /* The number of its data words */
+    int externWords; /* The number of its words with the external ARE bits */
+    int externSites; /* The number of the words listed in its .ext file */
+} LinkModule;
+
+/* An entry or an extern site of a module, from its .ent or .ext file */
+typedef struct {
+    char name[MAX_LABEL_LENGTH];
+    int address; /* The address in the module, as assembled */
+    int module; /* The index of the module */
+} LinkSymbol;
+
+DECLARE_TYPED_VECTOR(LinkModuleVector, LinkModule, link_module_vector)
+DEFINE_TYPED_VECTOR(LinkModuleVector, LinkModule, link_module_vector)
+DECLARE_TYPED_VECTOR(LinkSymbolVector, LinkSymbol, link_symbol_vector)
+DEFINE_TYPED_VECTOR(LinkSymbolVector, LinkSymbol, link_symbol_vector)
+
+/* The modules and the symbols of the linked program */
+typedef struct {
+    LinkModuleVector modules;
+    LinkSymbolVector entries;
+    LinkSymbolVector externs;
+    NameIndex entryIndex; /* The entries by name */
+    WordImage *code; /* The code of all the modules */
+    WordImage *data; /* The data of all the modules */
+    char *fileName; /* The buffer the names of a module's files are built in */
+} Linker;
+
+/**************************** Forward Declarations ****************************/
+Status readModule(Linker *linker, const char *name);
+
+Status readWords(Linker *linker, LinkModule *module, FILE *file);
+
+Status readSymbols(Linker *linker, int moduleIdx, const char *extension,
+                   LinkSymbolVector *symbols, Boolean inCode);
+
+int readWord(FILE *file);
+
+int relocate(const Linker *linker, const LinkModule *module, int address);
+
+void relocateModules(Linker *linker);
+
+int findEntry(const Linker *linker, const char *name);
+
+Status addEntries(Linker *linker, int firstEntry);
+
+Status resolveExterns(Linker *linker);
+
+/************************* Functions  Implementations *************************/
+/**
+ * Links the modules given as arguments into a single .ob file.
+ *
+ * @param argc - The number of command-line arguments.
+ * @param argv[] - The names of the modules, optionally mixed with --output.
+ *
+ * @return 0 if the modules were linked, 1 otherwise.
+ */
+int main(int argc, char *argv[]) {
+    Linker linker;
+    const char *outputName = DEFAULT_OUTPUT_NAME;
+    char *outputFile = NULL;
+    size_t maxLength = strlen(DEFAULT_OUTPUT_NAME);
+    int i, numOfModules = 0, firstEntry;
+    Status ret = SUCCESS;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--output") == 0) {
+            if (i + 1 >= argc) {
+                printf("Error: Option '%s' requires a name.\n", argv[i]);
+                return 1;
+            }
+            outputName = argv[++i];
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            printf("Error: Unknown option '%s'.\n", argv[i]);
+            return 1;
+        } else {
+            numOfModules++;
+        }
+        if (strlen(argv[i]) > maxLength) {
+            maxLength = strlen(argv[i]);
+        }
+    }
+    if (numOfModules < 1) {
+        printf("Usage: linker [--output <name>] <module1> ... <moduleN>\n");
+        return 1;
+    }
+
+    link_module_vector_init(&linker.modules, NULL);
+    link_symbol_vector_init(&linker.entries, NULL);
+    link_symbol_vector_init(&linker.externs, NULL);
+    name_index_init(&linker.entryIndex);
+    linker.code = new_word_image();
+    linker.data = new_word_image();
+    /* 5 for ".ent\0", the longest extension of a module's files */
+    linker.fileName = my_malloc(maxLength + 5);
+    outputFile = my_malloc(maxLength + MAX_OUTPUT_EXTENSION_LENGTH + 1);
+    if (linker.fileName == NULL || outputFile == NULL) {
+        printf("Error: Memory allocation for the linker was failed!\n");
+        exit(1);
+    }
+
+    /* Read the modules, laying out their code and data one after another */
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--output") == 0) {
+            i++;
+            continue;
+        }
+        firstEntry = linker.entries.size;
+        if (SUCCESS != readModule(&linker, argv[i])) {
+            ret = FAILURE;
+        } else if (SUCCESS != addEntries(&linker, firstEntry)) {
+            ret = FAILURE;
+        }
+    }
+
+    /* Once the size of all the code is known, the data addresses are too */
+    if (SUCCESS == ret) {
+        relocateModules(&linker);
+        ret = resolveExterns(&linker);
+    }
+    if (SUCCESS == ret) {
+        if (START_ADDRESS + linker.code->size + linker.data->size >
+            ISA_VALUE_MASK + 1) {
+            printf("Warning: The linked program ends at address %d, beyond "
+                   "the %d addresses a word can refer to.\n",
+                   START_ADDRESS + linker.code->size + linker.data->size - 1,
+                   ISA_VALUE_MASK + 1);
+        }
+        sprintf(outputFile, "%s%s", outputName,
+                getOutputEncoder(findOutputEncoder("base64"))->extension);
+        writeEncodedOutput(getOutputEncoder(findOutputEncoder("base64")),
+                           outputFile, linker.code, linker.data);
+    }
+
+    link_module_vector_free(&linker.modules);
+    link_symbol_vector_free(&linker.entries);
+    link_symbol_vector_free(&linker.externs);
+    name_index_free(&linker.entryIndex);
+    free_word_image(linker.code);
+    free_word_image(linker.data);
+    my_free(linker.fileName);
+    my_free(outputFile);
+
+    return SUCCESS == ret ? 0 : 1;
+}
+/******************************************************************************/
+/**
+ * Reads a module: appends its code and data words to those of the linked
+ * program, and adds its entries and extern sites.
+ *
+ * @param linker - The linker.
+ * @param name - The name of the module, without extensions.
+ *
+ * @return SUCCESS if the files of the module were read, FAILURE otherwise.
+ */
+Status readModule(Linker *linker, const char *name) {
+    LinkModule module;
+    LinkModule *stored = NULL;
+    FILE *file = NULL;
+    Status ret = SUCCESS;
+    int moduleIdx = linker->modules.size, firstExtern = linker->externs.size;
+
+    module.name = name;
+    module.codeBase = linker->code->size;
+    module.dataBase = linker->data->size;
+    module.externWords = 0;
+
+    sprintf(linker->fileName, "%s.ob", name);
+    file = fopen(linker->fileName, "r");
+    if (file == NULL) {
+        printf("Error: Failed to open the file: %s\n", linker->fileName);
+        return FAILURE;
+    }
+    ret = readWords(linker, &module, file);
+    fclose(file);
+    if (SUCCESS != ret) {
+        return FAILURE;
+    }
+    stored = link_module_vector_push(&linker->modules, module);
+
+    if (SUCCESS != readSymbols(linker, moduleIdx, ".ent", &linker->entries,
+                               FALSE) ||
+        SUCCESS != readSymbols(linker, moduleIdx, ".ext", &linker->externs,
+                               TRUE)) {
+        return FAILURE;
+    }
+    stored->externSites = linker->externs.size - firstExtern;
+    if (stored->externSites != stored->externWords) {
+        printf("Error: %s has %d external words, but %d are listed in "
+               "its .ext file.\n", name, stored->externWords,
+               stored->externSites);
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+/******************************************************************************/
+/**
+ * Reads the next word of an .ob file, two base64 characters on a line.
+ *
+ * @param file - The open .ob file.
+ *
+ * @return The word, or -1 at the end of the file or for an invalid line.
+ */
+int readWord(FILE *file) {
+    static const char base64Digits[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    static signed char base64Values[256];
+    static int initialized = 0;
+    char line[MAX_MODULE_LINE_LENGTH];
+    int i, high, low;
+
+    if (!initialized) {
+        memset(base64Values, -1, sizeof(base64Values));
+        for (i = 0; i < 64; i++) {
+            base64Values[(unsigned char) base64Digits[i]] = (signed char) i;
+        }
+        initialized = 1;
+    }
+    if (fgets(line, sizeof(line), file) == NULL ||
+        (high = base64Values[(unsigned char) line[0]]) == -1 ||
+        (low = base64Values[(unsigned char) line[1]]) == -1) {
+        return -1;
+    }
+    return (high << 6) | low;
+}
+/******************************************************************************/
+/**
+ * Reads the words of a module's .ob file: "IC DC" and then two base64
+ * characters for each word, its code words followed by its data words.
+ *
+ * @param linker - The linker, its code and data are appended the words.
+ * @param module - The module, its IC, DC and external words are set.
+ * @param file - The open .ob file.
+ *
+ * @return SUCCESS if the file is a valid .ob file, FAILURE otherwise.
+ */
+Status readWords(Linker *linker, LinkModule *module, FILE *file) {
+    char line[MAX_MODULE_LINE_LENGTH];
+    int i, word;
+
+    if (fgets(line, sizeof(line), file) == NULL ||
+        sscanf(line, "%d %d", &module->IC, &module->DC) != 2 ||
+        module->IC < 0 || module->DC < 0) {
+        printf("Error: %s.ob doesn't start with the IC and DC.\n",
+               module->name);
+        return FAILURE;
+    }
+
+    /* The words are read straight into the linked code and data */
+    for (i = 0; i < module->IC + module->DC; i++) {
+        word = readWord(file);
+        if (word == -1) {
+            printf("Error: %s.ob has an invalid word on line %d.\n",
+                   module->name, i + 2);
+            return FAILURE;
+        }
+        if (i >= module->IC) {
+            push_word(linker->data, word);
+        } else {
+            push_word(linker->code, word);
+            if (((word >> ISA_ARE_SHIFT) & ISA_ARE_MASK) == ISA_ARE_EXTERNAL) {
+                module->externWords++;
+            }
+        }
+    }
+    return SUCCESS;
+}
+/******************************************************************************/
+/**
+ * Reads the symbols of a module's .ent or .ext file, a label and its address
+ * on each line. A module without the file has no such symbols.
+ *
+ * @param linker - The linker.
+ * @param moduleIdx - The index of the module.
+ * @param extension - The extension of the file, ".ent" or ".ext".
+ * @param symbols - The symbols to add the symbols of the file to.
+ * @param inCode - Whether the symbols must be addresses of code words.
+ *
+ * @return SUCCESS if the file is valid or doesn't exist, FAILURE otherwise.
+ */
+Status readSymbols(Linker *linker, int moduleIdx, const char *extension,
+                   LinkSymbolVector *symbols, Boolean inCode) {
+    const LinkModule *module = &linker->modules.items[moduleIdx];
+    char line[MAX_MODULE_LINE_LENGTH];
+    char *separator = NULL;
+    LinkSymbol symbol;
+    FILE *file = NULL;
+    int lineNumber = 0;
+    Status ret = SUCCESS;
+
+    sprintf(linker->fileName, "%s%s", module->name, extension);
+    file = fopen(linker->fileName, "r");
+    if (file == NULL) {
+        return SUCCESS;
+    }
+
+    symbol.module = moduleIdx;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lineNumber++;
+        separator = strchr(line, ' ');
+        if (separator == NULL || separator - line >= MAX_LABEL_LENGTH ||
+            sscanf(separator + 1, "%d", &symbol.address) != 1 ||
+            symbol.address < START_ADDRESS ||
+            symbol.address >= START_ADDRESS + module->IC + module->DC ||
+            (inCode && symbol.address >= START_ADDRESS + module->IC)) {
+            printf("Error: Invalid symbol on line %d of %s.\n", lineNumber,
+                   linker->fileName);
+            ret = FAILURE;
+            break;
+        }
+        memcpy(symbol.name, line, separator - line);
+        symbol.name[separator - line] = '\0';
+        link_symbol_vector_push(symbols, symbol);
+    }
+
+    fclose(file);
+    return ret;
+}
+/******************************************************************************/
+/**
+ * Returns the address in the linked program of an address of a module. The
+ * module's code was assembled from START_ADDRESS, followed by its data.
+ *
+ * @param linker - The linker, with all the modules read.
+ * @param module - The module.
+ * @param address - The address in the module.
+ *
+ * @return The address in the linked program.
+ */
+int relocate(const Linker *linker, const LinkModule *module, int address) {
+    if (address < START_ADDRESS + module->IC) {
+        return address + module->codeBase;
+    }
+    return address - module->IC + linker->code->size + module->dataBase;
+}
+/******************************************************************************/
+/**
+ * Moves the relocatable words of each module, and its entries, to the
+ * addresses of the module in the linked program.
+ *
+ * @param linker - The linker, with all the modules read.
+ */
+void relocateModules(Linker *linker) {
+    const LinkModule *module = NULL;
+    unsigned short *word = NULL;
+    LinkSymbol *entry = NULL;
+    int i, j, address;
+
+    for (i = 0; i < linker->modules.size; i++) {
+        module = &linker->modules.items[i];
+        for (j = 0; j < module->IC; j++) {
+            word = &linker->code->words[module->codeBase + j];
+            if (((*word >> ISA_ARE_SHIFT) & ISA_ARE_MASK) ==
+                ISA_ARE_RELOCATABLE) {
+                address = (*word >> ISA_VALUE_SHIFT) & ISA_VALUE_MASK;
+                *word = (unsigned short)
+                        (((relocate(linker, module, address) &
+                           ISA_VALUE_MASK) << ISA_VALUE_SHIFT) |
+                         (ISA_ARE_RELOCATABLE << ISA_ARE_SHIFT));
+            }
+        }
+    }
+
+    for (i = 0; i < linker->entries.size; i++) {
+        entry = &linker->entries.items[i];
+        entry->address = relocate(linker,
+                                  &linker->modules.items[entry->module],
+                                  entry->address);
+    }
+}
+/******************************************************************************/
+/**
+ * Returns the index of the entry with the given name.
+ *
+ * @param linker - The linker.
+ * @param name - The name of the entry.
+ *
+ * @return The index of the entry, or -1 if no module has such an entry.
+ */
+int findEntry(const Linker *linker, const char *name) {
+    unsigned long hash = name_hash(name, strlen(name));
+    int slot = name_index_start(&linker->entryIndex, hash);
+    int entryIdx;
+
+    while ((entryIdx = name_index_next(&linker->entryIndex, hash, &slot)) !=
+           -1) {
+        if (strcmp(linker->entries.items[entryIdx].name, name) == 0) {
+            return entryIdx;
+        }
+    }
+    return -1;
+}
+/******************************************************************************/
+/**
+ * Indexes the entries of the module read last by their names. An entry can
+ * be defined by a single module.
+ *
+ * @param linker - The linker.
+ * @param firstEntry - The index of the first entry of the module.
+ *
+ * @return SUCCESS if no other module defines the entries, FAILURE otherwise.
+ */
+Status addEntries(Linker *linker, int firstEntry) {
+    const LinkSymbol *entry = NULL;
+    int i, otherIdx;
+    Status ret = SUCCESS;
+
+    for (i = firstEntry; i < linker->entries.size; i++) {
+        entry = &linker->entries.items[i];
+        otherIdx = findEntry(linker, entry->name);
+        if (otherIdx != -1) {
+            printf("Error: The entry '%s' of %s is already defined by %s.\n",
+                   entry->name, linker->modules.items[entry->module].name,
+                   linker->modules.items[linker->entries.items[otherIdx].module]
+                           .name);
+            ret = FAILURE;
+            continue;
+        }
+        name_index_insert(&linker->entryIndex,
+                          name_hash(entry->name, strlen(entry->name)), i);
+    }
+    return ret;
+}
+/******************************************************************************/
+/**
+ * Patches each word listed in the .ext file of a module with the address of
+ * the entry of that name, as a relocatable word of the linked program.
+ *
+ * @param linker - The linker, with the modules relocated.
+ *
+ * @return SUCCESS if every extern is an entry of a module, FAILURE otherwise.
+ */
+Status resolveExterns(Linker *linker) {
+    const LinkSymbol *site = NULL;
+    const LinkModule *module = NULL;
+    unsigned short *word = NULL;
+    int i, entryIdx;
+    Status ret = SUCCESS;
+
+    for (i = 0; i < linker->externs.size; i++) {
+        site = &linker->externs.items[i];
+        module = &linker->modules.items[site->module];
+        word = &linker->code->words[module->codeBase + site->address -
+                                    START_ADDRESS];
+        entryIdx = findEntry(linker, site->name);
+        if (((*word >> ISA_ARE_SHIFT) & ISA_ARE_MASK) != ISA_ARE_EXTERNAL) {
+            printf("Error: The word at address %d of %s isn't external.\n",
+                   site->address, module->name);
+            ret = FAILURE;
+        } else if (entryIdx == -1) {
+            printf("Error: The extern '%s' of %s isn't an entry of any "
+                   "module.\n", site->name, module->name);
+            ret = FAILURE;
+        } else {
+            *word = (unsigned short)
+                    (((linker->entries.items[entryIdx].address &
+                       ISA_VALUE_MASK) << ISA_VALUE_SHIFT) |
+                     (ISA_ARE_RELOCATABLE << ISA_ARE_SHIFT));
+        }
+    }
+    return ret;
+}
+/******************************************************************************/
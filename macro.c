@@ -11,24 +11,33 @@
 
 /******************************** Header Files ********************************/
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "macro.h"
-#include "utils.h"  /* my_strdup function */
+#include "utils.h"  /* my_malloc function */
+#include "stats.h"
 
 /************************* Functions  Implementations *************************/
+DEFINE_TYPED_VECTOR(MacroList, Macro *, macro_list)
+/******************************************************************************/
 /**
  * Creates a new MacroVector, allocates initial memory, and sets default values.
  *
  * @return - A pointer to the newly created MacroVector.
  *
- * The function allocates memory for a MacroVector struct and an array of Macro pointers,
- * sets the initial capacity and size, and returns a pointer to the new MacroVector.
+ * The function allocates memory for a MacroVector struct and initializes its
+ * empty list of Macros, and returns a pointer to the new MacroVector.
  */
 MacroVector *new_macro_vector() {
-    MacroVector *mv = malloc(sizeof(MacroVector));
-    mv->capacity = INITIAL_CAPACITY;
-    mv->size = 0;
-    mv->macros = malloc(sizeof(Macro *) * mv->capacity);
+    MacroVector *mv = my_malloc(sizeof(MacroVector));
+    if (mv == NULL) {
+        fprintf(stderr, "Error allocating memory for a macro vector\n");
+        exit(1);
+    }
+    macro_list_init(&mv->macros, NULL);
+    name_index_init(&mv->index);
+    mv->spares = NULL;
     return mv;
 }
 /******************************************************************************/
@@ -38,48 +47,220 @@ MacroVector *new_macro_vector() {
  * @param mv - A pointer to the MacroVector.
  * @param m - A pointer to the Macro to be added.
  *
- * If the MacroVector's current size has reached its capacity,
- * the function doubles the capacity by reallocating memory.
- * The Macro is then added to the end of the MacroVector.
+ * The Macro is added to the end of the list of the MacroVector, which grows
+ * as needed.
  */
 void push_back_macro(MacroVector *mv, Macro *m) {
-    if (mv->size == mv->capacity) {
-        mv->capacity *= 2;
-        mv->macros = realloc(mv->macros, sizeof(Macro *) * mv->capacity);
-    }
-    mv->macros[mv->size++] = m;
+    name_index_insert(&mv->index, name_hash(m->name, strlen(m->name)),
+                      mv->macros.size);
+    macro_list_push(&mv->macros, m);
 }
 /******************************************************************************/
 /**
  * Creates a new Macro with the given name.
  *
  * @param name - The name to be assigned to the new Macro.
+ * @param scope - The MacroVector of the macros visible where it is defined.
  * @return - A pointer to the new Macro.
  *
- * The function allocates memory for a Macro struct,
- * duplicates the provided name string and assigns it to the Macro,
- * initializes a new command vector for the Macro,
- * and returns a pointer to the new Macro.
+ * The function takes a spare Macro of the scope, or allocates memory for a
+ * Macro struct and a command vector if there is none. It copies the provided
+ * name string into the Macro, growing its name buffer only if it is too
+ * short, and returns a pointer to the new Macro. Its expansion is computed
+ * later, on first use.
  */
-Macro *new_macro(char *name) {
-    Macro *m = malloc(sizeof(Macro));
-    m->name = my_strdup(name);
-    m->commands = new_vector();
+Macro *new_macro(char *name, MacroVector *scope) {
+    Macro *m = scope->spares;
+    int length = (int) strlen(name) + 1;
+
+    if (m != NULL) {
+        scope->spares = m->nextSpare;
+        reset_vector(m->commands);
+    } else {
+        m = my_malloc(sizeof(Macro));
+        if (m == NULL) {
+            fprintf(stderr, "Error allocating memory for a macro\n");
+            exit(1);
+        }
+        m->name = NULL;
+        m->nameCapacity = 0;
+        m->commands = new_vector();
+        m->flattened = NULL;
+    }
+    if (length > m->nameCapacity) {
+        my_free(m->name);
+        m->name = my_malloc(length);
+        if (m->name == NULL) {
+            fprintf(stderr, "Error allocating memory\n");
+            exit(1);
+        }
+        m->nameCapacity = length;
+    }
+    memcpy(m->name, name, length);
+    m->expansion = NULL;
+    m->scope = scope;
+    m->nextSpare = NULL;
+    m->expansionState = MACRO_NOT_EXPANDED;
+    m->isShared = 0;
     return m;
 }
 /******************************************************************************/
+/**
+ * Finds the macro invoked by a line.
+ *
+ * @param mv - A pointer to the MacroVector to search.
+ * @param line - The line, without leading whitespaces.
+ * @return - A pointer to the invoked Macro, or NULL if there is none.
+ *
+ * If the line starts with the name of a macro, this indicates a macro
+ * invocation. The macro name is followed by either a space, newline or null
+ * character. When several macros match, the first one defined is returned.
+ * The macros are found by the name index of the MacroVector, so only the
+ * macros with the hash of the first word of the line are compared.
+ */
+Macro *find_macro(const MacroVector *mv, const char *line) {
+    size_t length = strcspn(line, " \n");
+    unsigned long hash = name_hash(line, length);
+    int slot = name_index_start(&mv->index, hash);
+    int i, first = -1;
+    const char *name;
+
+    STATS_COUNT(STAT_SYMBOL_LOOKUPS);
+    while ((i = name_index_next(&mv->index, hash, &slot)) != -1) {
+        STATS_COUNT(STAT_STRING_COMPARISONS);
+        name = mv->macros.items[i]->name;
+        if (strncmp(line, name, length) == 0 && name[length] == '\0' &&
+            (first == -1 || i < first)) {
+            first = i;
+        }
+    }
+    return first != -1 ? mv->macros.items[first] : NULL;
+}
+/******************************************************************************/
 /**
  * Frees all memory associated with a Macro, including its name and commands.
  *
  * @param m - A pointer to the Macro to be freed.
  *
  * The function frees the memory allocated for the Macro's name string,
- * then frees the command vector associated with the Macro,
+ * then frees its expansion and the command vector associated with the Macro,
  * and finally frees the memory allocated for the Macro struct itself.
+ * The commands and the expansion only refer to lines owned by arenas.
  */
 void free_macro(Macro *m) {
-    free(m->name);
-    free_vector(m->commands);
-    free(m);
+    my_free(m->name);
+    if (m->flattened != NULL) {
+        free_vector_shallow(m->flattened);
+    }
+    free_vector_shallow(m->commands);
+    my_free(m);
+}
+/******************************************************************************/
+/**
+ * Frees the spare Macros of a MacroVector.
+ *
+ * @param mv - A pointer to the MacroVector.
+ */
+void free_spare_macros(MacroVector *mv) {
+    Macro *next = NULL;
+    while (mv->spares != NULL) {
+        next = mv->spares->nextSpare;
+        free_macro(mv->spares);
+        mv->spares = next;
+    }
+}
+/******************************************************************************/
+/**
+ * Seeds a MacroVector with the Macros of a macro library.
+ *
+ * @param mv - A pointer to the MacroVector.
+ * @param library - A pointer to the MacroVector holding the library's Macros.
+ *
+ * The library's Macros are shared, not copied: the MacroVector only stores
+ * pointers to them, so they are looked up like any other macro but are freed
+ * only with the library itself.
+ */
+void seed_macro_vector(MacroVector *mv, const MacroVector *library) {
+    int i;
+    for (i = 0; i < library->macros.size; ++i) {
+        push_back_macro(mv, library->macros.items[i]);
+    }
+}
+/******************************************************************************/
+/**
+ * Marks all the Macros of a MacroVector as shared.
+ *
+ * @param mv - A pointer to the MacroVector.
+ *
+ * Shared Macros are skipped by free_macro_vector, so they can be added to the
+ * MacroVectors of other files and outlive them.
+ */
+void share_macros(MacroVector *mv) {
+    int i;
+    for (i = 0; i < mv->macros.size; ++i) {
+        mv->macros.items[i]->isShared = 1;
+    }
+}
+/******************************************************************************/
+/**
+ * Frees a MacroVector, including every Macro it holds that isn't shared.
+ *
+ * @param mv - A pointer to the MacroVector to be freed.
+ *
+ * The function frees each Macro with free_macro, except for the shared ones,
+ * then frees the array of Macro pointers and finally the MacroVector struct itself.
+ */
+void free_macro_vector(MacroVector *mv) {
+    int i;
+    for (i = 0; i < mv->macros.size; ++i) {
+        if (!mv->macros.items[i]->isShared) {
+            free_macro(mv->macros.items[i]);
+        }
+    }
+    free_spare_macros(mv);
+    macro_list_free(&mv->macros);
+    name_index_free(&mv->index);
+    my_free(mv);
+}
+/******************************************************************************/
+/**
+ * Frees a MacroVector, including every Macro it holds.
+ *
+ * @param mv - A pointer to the MacroVector to be freed.
+ *
+ * Called by the owner of shared Macros, once no other MacroVector uses them.
+ */
+void free_shared_macros(MacroVector *mv) {
+    int i;
+    for (i = 0; i < mv->macros.size; ++i) {
+        free_macro(mv->macros.items[i]);
+    }
+    free_spare_macros(mv);
+    macro_list_free(&mv->macros);
+    name_index_free(&mv->index);
+    my_free(mv);
+}
+/******************************************************************************/
+/**
+ * Empties a MacroVector, keeping the Macros it holds that aren't shared as
+ * its spares.
+ *
+ * @param mv - A pointer to the MacroVector.
+ *
+ * The shared Macros are owned by a macro library or an included file, and
+ * are only dropped from the MacroVector. The spares are listed in the order
+ * the Macros were defined, so a file defining the same macros again reuses
+ * each Macro with buffers of the right size.
+ */
+void reset_macro_vector(MacroVector *mv) {
+    int i;
+    for (i = mv->macros.size - 1; i >= 0; --i) {
+        if (!mv->macros.items[i]->isShared) {
+            mv->macros.items[i]->nextSpare = mv->spares;
+            mv->spares = mv->macros.items[i];
+        }
+    }
+    macro_list_clear(&mv->macros);
+    name_index_clear(&mv->index);
 }
 /******************************************************************************/
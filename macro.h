@@ -12,20 +12,53 @@
 #define MACRO_H
 
 #include "vector.h" /* for Vector struct */
+#include "typed_vector.h"
+#include "name_index.h"
+
+/***************************** Enums  Definitions *****************************/
+/* The state of the flattened expansion of a macro */
+typedef enum {
+    MACRO_NOT_EXPANDED, /* The expansion wasn't needed yet */
+    MACRO_EXPANDING, /* Being flattened, reaching it again means recursion */
+    MACRO_EXPANDED,
+    MACRO_RECURSIVE /* The macro invokes itself, it can't be expanded */
+} MacroExpansionState;
 
 /**************************** Structs  Definitions ****************************/
-/* A struct representing a Macro. It has a name and a list of commands. */
-typedef struct {
+/** A struct representing a Macro. It has a name and a list of commands.
+ * Each command is a TokenizedLine, tokenized once when the macro is defined,
+ * and owned by the arena of the file defining the macro.
+ * The expansion is the list of commands with every nested macro call replaced
+ * by that macro's expansion. It is computed on first use and then reused; when
+ * there are no nested calls it is the commands vector itself.
+ * Nested calls are looked up in the scope, the macros visible where the macro
+ * was defined, so the expansion is the same for every file using the macro.
+ * A shared macro belongs to a macro library or an included file, and is
+ * never freed by the MacroVectors of the files using it. */
+typedef struct Macro {
     char *name;
+    int nameCapacity; /* The size of the name buffer */
     Vector *commands;
+    Vector *expansion;
+    Vector *flattened; /* Holds the expansion when it isn't the commands, or NULL */
+    struct MacroVector *scope;
+    struct Macro *nextSpare; /* The next Macro in the spares of a MacroVector */
+    MacroExpansionState expansionState;
+    int isShared;
 } Macro;
 
+/* A vector of Macro pointers. The Macros themselves are referred to by the
+ * MacroVectors of every file they are visible in, so they don't move */
+DECLARE_TYPED_VECTOR(MacroList, Macro *, macro_list)
+
 /** A struct representing a MacroVector.
- * It contains an array of Macro pointers and size information. */
-typedef struct {
-    Macro **macros;
-    int size;
-    int capacity;
+ * It contains the list of the Macros visible in a file or a library.
+ * When it is reset, its own Macros are kept as spares, and reused with their
+ * memory by the next Macros defined in its scope. */
+typedef struct MacroVector {
+    MacroList macros;
+    NameIndex index; /* The indices of the Macros in macros, by their names */
+    Macro *spares; /* A list of Macros to reuse, linked by nextSpare */
 } MacroVector;
 /******************************************************************************/
 /**
@@ -40,16 +73,52 @@ MacroVector *new_macro_vector();
  */
 void push_back_macro(MacroVector *mv, Macro *m);
 /**
- * Creates a new Macro.
+ * Creates a new Macro, reusing a spare Macro of the scope if there is one.
  * @param name - The name to be assigned to the new Macro.
+ * @param scope - The MacroVector of the macros visible where it is defined.
  * @return A pointer to the new Macro.
  */
-Macro *new_macro(char *name);
+Macro *new_macro(char *name, MacroVector *scope);
+/**
+ * Finds the macro invoked by a line.
+ * @param mv - A pointer to the MacroVector to search.
+ * @param line - The line, without leading whitespaces.
+ * @return A pointer to the invoked Macro, or NULL if the line isn't a macro call.
+ */
+Macro *find_macro(const MacroVector *mv, const char *line);
 /**
  * Frees all memory associated with a Macro.
  * @param m - A pointer to the Macro to be freed.
  */
 void free_macro(Macro *m);
+/**
+ * Adds all the Macros of a macro library to a MacroVector, without copying them.
+ * @param mv - A pointer to the MacroVector.
+ * @param library - A pointer to the MacroVector of the library.
+ */
+void seed_macro_vector(MacroVector *mv, const MacroVector *library);
+/**
+ * Marks all the Macros of a MacroVector as shared.
+ * @param mv - A pointer to the MacroVector.
+ */
+void share_macros(MacroVector *mv);
+/**
+ * Frees a MacroVector and all the Macros it holds that aren't shared.
+ * @param mv - A pointer to the MacroVector to be freed.
+ */
+void free_macro_vector(MacroVector *mv);
+/**
+ * Frees a MacroVector and all the Macros it holds, shared or not.
+ * Used by the owner of shared macros (a macro library or an included file).
+ * @param mv - A pointer to the MacroVector to be freed.
+ */
+void free_shared_macros(MacroVector *mv);
+/**
+ * Empties a MacroVector. The Macros it holds that aren't shared become its
+ * spares, so that the next Macros defined in it don't allocate memory.
+ * @param mv - A pointer to the MacroVector.
+ */
+void reset_macro_vector(MacroVector *mv);
 /******************************************************************************/
 #endif
 
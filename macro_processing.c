@@ -6,10 +6,12 @@
 *                       managing macro constructs in the our compiler program.
 *                       It implements procedures for recognizing reserved
 *                       keywords, validating macro definitions and performing
-*                       a pre-processing step on assembly language input files.
+*                       a pre-processing step on assembly language input files,
+*                       or on their contents in memory.
 *                       This preprocessing step identifies macro definitions,
-*                       expands macros at their invocation, and writes the
-*                       transformed code to an output file.
+*                       expands macros at their invocation, splices the lines
+*                       of included files and writes the transformed code to
+*                       an output file.
 *                       These routines contribute to the larger task of
 *                       parsing and interpreting the assembly language.
 \******************************************************************************/
@@ -23,19 +25,83 @@
 #include "macro_processing.h"
 #include "macro.h"
 #include "param_validation.h"
+#include "line_tokenizer.h"
+#include "include_cache.h"
+#include "stats.h"
+#include "trace.h"
+#include "print_error.h" /* for CountError and ErrorLimitReached */
+
+/**************************** Structs  Definitions ****************************/
+/* The file being preprocessed and where the results of preprocessing it go */
+typedef struct {
+    const char *file_name; /* The file being preprocessed, includes are relative to it */
+    const char *origin_file; /* Recorded on the tokenized lines, NULL for the processed file itself */
+    ProgramState *programState; /* The current state of the program, or NULL */
+    MacroVector *macros; /* The macros visible in the file */
+    Vector *lines; /* The tokenized lines of the file after expansion */
+    Arena *arena; /* Owns the tokenized lines of the file and of its macros */
+    Vector *includeCache; /* The files included in the run, NULL if '.include' isn't allowed */
+    Vector *includes; /* The IncludedFiles directly included by the file, or NULL */
+    const char *processed_file; /* The processed file, in progress until all its includes are done, or NULL */
+} PreprocessContext;
+
+/* The source of the lines of a file being preprocessed: an open file, or a
+ * buffer in memory */
+typedef struct {
+    FILE *file; /* The open file, or NULL to read the buffer */
+    const char *buffer;
+    size_t size; /* The number of bytes of the buffer */
+    size_t position; /* The offset of the next line in the buffer */
+} SourceReader;
 
 /**************************** Forward Declarations ****************************/
 int isReservedKeyword(char *word, ProgramState *programState);
 
 int isValidMacroDefinition(const char *line);
 
+void initProgramContext(PreprocessContext *context, const char *file_name,
+                        ProgramState *programState);
+
+char *readSourceLine(char *line, int size, SourceReader *reader);
+
+void rewindSource(SourceReader *reader);
+
+long sourcePosition(const SourceReader *reader);
+
+Status preprocessFile(SourceReader *reader, PreprocessContext *context,
+                      FILE *outputFile);
+
+Status collectMacros(SourceReader *reader, PreprocessContext *context,
+                     Boolean macrosOnly);
+
+int isIncludeDirective(const char *line);
+
+IncludedFile *findInclude(PreprocessContext *context, const char *line,
+                          int line_number, Boolean report);
+
+IncludedFile *includeFile(PreprocessContext *context, const char *path,
+                          int line_number);
+
+void addIncludedMacros(MacroVector *macroVector, IncludedFile *includedFile);
+
+Vector *expandMacro(Macro *macro);
+
+Status expandMacros(MacroVector *macroVector);
+
+void printPreprocessError(const char *origin_file, int line_number,
+                          const char *message, const char *argument);
+
+int stopAtErrorLimit(const PreprocessContext *context);
+
 /************************* Functions  Implementations *************************/
 /**
  * Preprocesses the given input file and writes the result to the output file.
- * Preprocessing involves expanding any macros defined in the input file.
+ * Preprocessing involves expanding any macros defined in the input file and
+ * splicing the lines of the files it includes.
  *
  * @param input_file The name of the file to preprocess.
- * @param output_file The name of the file to write the preprocessed code to.
+ * @param output_file The name of the file to write the preprocessed code to,
+ *                    or NULL to write no .am file (--check).
  * @param programState The current state of the program.
  *
  * @return SUCCESS if the preprocessing is successful, FAILURE otherwise.
@@ -44,29 +110,344 @@ Status preProcess(const char *input_file, const char *output_file,
                   ProgramState *programState) {
     /* Variable Initializations */
     Status ret = SUCCESS;
-    int i, count_line = 0;
-    char line[1024];
-    char *ptr = NULL, *newline = NULL, *end = NULL;
     FILE *inputFile = NULL, *outputFile = NULL;
-    Macro *macroToExpand = NULL;
-    Macro *currentMacro = NULL;
-    MacroVector *macroVector = new_macro_vector();
+    PreprocessContext context;
+    SourceReader reader;
+
+    initProgramContext(&context, input_file, programState);
 
     /* Open input and output files. If opening fails, return FAILURE */
     inputFile = fopen(input_file, "r");
     if (NULL == inputFile) {
         return FAILURE;
     }
-    outputFile = fopen(output_file, "w");
-    if (NULL == outputFile) {
-        if (inputFile != NULL) {
+    if (output_file != NULL) {
+        outputFile = fopen(output_file, "w");
+        if (NULL == outputFile) {
             fclose(inputFile);
+            return FAILURE;
+        }
+    }
+
+    reader.file = inputFile;
+    ret = preprocessFile(&reader, &context, outputFile);
+
+    /* Cleanup: Close files. The macros are kept in the program state,
+     * since the .am lines refer to their tokenized bodies. */
+    fclose(inputFile);
+    if (outputFile != NULL) {
+        STATS_ADD(STAT_BYTES_WRITTEN, ftell(outputFile));
+        fclose(outputFile);
+    }
+
+    return ret;
+}
+/******************************************************************************/
+/**
+ * Preprocesses the contents of a source file held in memory, the same as
+ * preProcess but without writing the .am file. Nothing is read from disk
+ * unless the program state has an include cache and the source includes a
+ * file.
+ *
+ * @param buffer The contents of the source file, not necessarily terminated
+ *               by a null character.
+ * @param size The number of bytes of the buffer.
+ * @param file_name The name of the source file, includes are relative to it.
+ * @param programState The current state of the program.
+ *
+ * @return SUCCESS if the preprocessing is successful, FAILURE otherwise.
+ */
+Status preProcessBuffer(const char *buffer, size_t size,
+                        const char *file_name, ProgramState *programState) {
+    Status ret = SUCCESS;
+    PreprocessContext context;
+    SourceReader reader;
+
+    initProgramContext(&context, file_name, programState);
+    reader.file = NULL;
+    reader.buffer = buffer;
+    reader.size = size;
+    reader.position = 0;
+
+    ret = preprocessFile(&reader, &context, NULL);
+    return ret;
+}
+/******************************************************************************/
+/**
+ * Sets up the context of preprocessing a processed file: its macros and
+ * lines are those of the program state.
+ *
+ * @param context The context to set up.
+ * @param file_name The name of the processed file.
+ * @param programState The current state of the program.
+ */
+void initProgramContext(PreprocessContext *context, const char *file_name,
+                        ProgramState *programState) {
+    context->file_name = file_name;
+    context->origin_file = NULL;
+    context->programState = programState;
+    context->macros = programState->macros;
+    context->lines = programState->amLines;
+    context->arena = programState->arena;
+    context->includeCache = programState->includeCache;
+    context->includes = NULL;
+    context->processed_file = file_name;
+}
+/******************************************************************************/
+/**
+ * Reads the next line of a source, like fgets: up to size - 1 characters,
+ * stopping after a newline, followed by a null character.
+ *
+ * @param line The buffer to read the line into.
+ * @param size The size of the buffer.
+ * @param reader The source to read from.
+ *
+ * @return line, or NULL at the end of the source.
+ */
+char *readSourceLine(char *line, int size, SourceReader *reader) {
+    int length = 0;
+
+    if (reader->file != NULL) {
+        return fgets(line, size, reader->file);
+    }
+    if (reader->position >= reader->size) {
+        return NULL;
+    }
+    while (length < size - 1 && reader->position < reader->size) {
+        line[length] = reader->buffer[reader->position++];
+        if (line[length++] == '\n') {
+            break;
         }
+    }
+    line[length] = '\0';
+    return line;
+}
+/******************************************************************************/
+/**
+ * Moves back to the first line of a source.
+ *
+ * @param reader The source.
+ */
+void rewindSource(SourceReader *reader) {
+    if (reader->file != NULL) {
+        rewind(reader->file);
+    } else {
+        reader->position = 0;
+    }
+}
+/******************************************************************************/
+/**
+ * Returns the number of bytes read from a source.
+ *
+ * @param reader The source.
+ */
+long sourcePosition(const SourceReader *reader) {
+    return reader->file != NULL ? ftell(reader->file)
+                                : (long) reader->position;
+}
+/******************************************************************************/
+/**
+ * Builds a macro library: reads the macro definitions of the library file,
+ * validates their names against the reserved keywords and tokenizes their
+ * bodies. This is done once per run, and every processed file is then seeded
+ * with the library's macros instead of parsing them again.
+ *
+ * @param library_file The name of the macro library file.
+ * @param library The MacroVector to store the library's macros in.
+ * @param arena The arena to allocate the library's tokenized lines from.
+ *
+ * @return SUCCESS if the library is valid, FAILURE otherwise.
+ */
+Status buildMacroLibrary(const char *library_file, MacroVector *library,
+                         Arena *arena) {
+    Status ret = SUCCESS;
+    FILE *inputFile = fopen(library_file, "r");
+    PreprocessContext context;
+    SourceReader reader;
+
+    if (NULL == inputFile) {
+        fprintf(stderr, "Error: Failed to open the macro library %s.\n",
+                library_file);
         return FAILURE;
     }
 
-    /* First pass: build the list of macros */
-    while (fgets(line, sizeof(line), inputFile)) {
+    /* A library has no labels to collide with, only reserved words */
+    context.file_name = library_file;
+    context.origin_file = library_file;
+    context.programState = NULL;
+    context.macros = library;
+    context.lines = NULL;
+    context.arena = arena;
+    context.includeCache = NULL;
+    context.includes = NULL;
+    context.processed_file = NULL;
+    reader.file = inputFile;
+    ret = collectMacros(&reader, &context, TRUE);
+    if (expandMacros(library) == FAILURE) {
+        ret = FAILURE;
+    }
+    share_macros(library);
+
+    fclose(inputFile);
+    return ret;
+}
+/******************************************************************************/
+/**
+ * Preprocesses a source in two passes: the first collects its macros and
+ * the macros of the files it includes, the second expands the file into
+ * tokenized lines.
+ *
+ * @param reader The source to preprocess.
+ * @param context Where the macros and lines of the file are stored.
+ * @param outputFile The file to write the expanded lines to, or NULL.
+ *
+ * @return SUCCESS if the preprocessing is successful, FAILURE otherwise.
+ */
+Status preprocessFile(SourceReader *reader, PreprocessContext *context,
+                      FILE *outputFile) {
+    Status ret = SUCCESS;
+    int i, count_line = 0;
+    char line[MAX_SOURCE_LINE_LENGTH];
+    char *ptr = NULL, *newline = NULL;
+    Macro *macroToExpand = NULL;
+    MacroVector *macroVector = context->macros;
+    TokenizedLine *tokenizedLine = NULL;
+    IncludedFile *includedFile = NULL;
+    Vector *expandedLines = NULL;
+
+    /* First pass: build the list of macros. Each source, the processed file
+     * or an included one, is counted once, by how far this pass read it */
+    ret = collectMacros(reader, context, FALSE);
+    STATS_ADD(STAT_BYTES_READ, sourcePosition(reader));
+    if (expandMacros(macroVector) == FAILURE) {
+        ret = FAILURE;
+    }
+    if (stopAtErrorLimit(context)) {
+        return FAILURE;
+    }
+
+    /* Rewind the input file to the beginning for the second pass */
+    rewindSource(reader);
+
+    /* Second pass: output the file, expanding macros */
+    while (readSourceLine(line, sizeof(line), reader)) {
+        if (stopAtErrorLimit(context)) {
+            ret = FAILURE;
+            break;
+        }
+        count_line++;
+        if (1 == filter_line(line)) {
+            continue;
+        }
+        ptr = line;
+        /* Skip leading whitespaces */
+        while (isspace((unsigned char) *ptr)) {
+            ptr++;
+        }
+
+        /* Remove the newline at the end of the line, if present */
+        newline = strchr(ptr, '\n');
+        if (newline) {
+            *newline = '\0';
+        }
+
+        /* If the line starts with a macro definition or end of macro, skip it */
+        if (strncmp(ptr, "mcro", 4) == 0) {
+            do {
+                if (readSourceLine(line, sizeof(line), reader) == NULL) {
+                    break; /* a macro that is never closed ends the file */
+                }
+                count_line++;
+                ptr = line;
+                while (isspace((unsigned char) *ptr)) {
+                    ptr++;
+                }
+                newline = strchr(ptr, '\n');
+                if (newline) {
+                    *newline = '\0';
+                }
+            } while (strncmp(ptr, "endmcro", 7) != 0);
+            continue;
+        }
+
+        /* An included file was already preprocessed in the first pass, splice its lines */
+        if (context->includeCache != NULL && isIncludeDirective(ptr)) {
+            includedFile = findInclude(context, ptr, count_line, FALSE);
+            expandedLines = includedFile != NULL ? includedFile->lines : NULL;
+            for (i = 0; expandedLines != NULL && i < expandedLines->size; ++i) {
+                tokenizedLine = expandedLines->items[i];
+                push_back(context->lines, tokenizedLine);
+                if (outputFile != NULL) {
+                    fputs(tokenizedLine->text, outputFile);
+                    fputs("\n", outputFile);
+                }
+            }
+            continue;
+        }
+
+        /* Check if the line invokes a macro */
+        macroToExpand = find_macro(macroVector, ptr);
+
+        if (macroToExpand) {
+            STATS_COUNT(STAT_MACROS_EXPANDED);
+            /* Expand the macro by splicing its already tokenized and flattened lines */
+            expandedLines = expandMacro(macroToExpand);
+            if (expandedLines == NULL) {
+                ret = FAILURE;
+            } else if (traceEnabled &&
+                       expandedLines->size >= TRACE_LARGE_MACRO_LINES) {
+                trace_instant(macroToExpand->name, "macro",
+                              expandedLines->size);
+            }
+            for (i = 0; expandedLines != NULL && i < expandedLines->size; ++i) {
+                tokenizedLine = expandedLines->items[i];
+                push_back(context->lines, tokenizedLine);
+                if (outputFile != NULL) {
+                    fputs(tokenizedLine->text, outputFile);
+                    fputs("\n", outputFile);
+                }
+            }
+        } else {
+            /* Otherwise, tokenize the line and write it to the output as is */
+            tokenizedLine = tokenizeLine(ptr, context->origin_file,
+                                         count_line, context->arena);
+            push_back(context->lines, tokenizedLine);
+            if (outputFile != NULL) {
+                fputs(ptr, outputFile);
+                fputs("\n", outputFile);
+            }
+        }
+    }
+
+    return ret;
+}
+/******************************************************************************/
+/**
+ * Reads the macro definitions of the given file, validates their names and
+ * adds them, with their tokenized bodies, to the MacroVector of the context.
+ * The macros of every file included by the file are added to it as well.
+ *
+ * @param reader - The source to read the macro definitions from.
+ * @param context - The file being preprocessed and its MacroVector.
+ * @param macrosOnly - TRUE if every line of the file must be part of a macro.
+ *
+ * @return SUCCESS if all the macro definitions are valid, FAILURE otherwise.
+ */
+Status collectMacros(SourceReader *reader, PreprocessContext *context,
+                     Boolean macrosOnly) {
+    Status ret = SUCCESS;
+    int count_line = 0;
+    char line[MAX_SOURCE_LINE_LENGTH];
+    char *ptr = NULL, *newline = NULL, *end = NULL;
+    Macro *currentMacro = NULL;
+    IncludedFile *includedFile = NULL;
+    Boolean inDefinition = FALSE; /* TRUE between 'mcro' and 'endmcro', even for an invalid macro */
+
+    while (readSourceLine(line, sizeof(line), reader)) {
+        if (stopAtErrorLimit(context)) {
+            ret = FAILURE;
+            break;
+        }
         count_line++;
         /* Filter out comments and empty lines */
         if (1 == filter_line(line)) {
@@ -80,6 +461,7 @@ Status preProcess(const char *input_file, const char *output_file,
 
         /* Check for macro definitions */
         if (strncmp(ptr, "mcro", 4) == 0) {
+            inDefinition = TRUE;
             ptr += 4;
             while (isspace((unsigned char) *ptr)) {
                 ptr++;
@@ -90,20 +472,21 @@ Status preProcess(const char *input_file, const char *output_file,
             }
             *(end + 1) = '\0';
 
-            if (!isReservedKeyword(ptr, programState)) {
+            if (!isReservedKeyword(ptr, context->programState)) {
                 if (!isValidMacroDefinition(
                         line)) {  /*Check validity of entire line*/
-                    fprintf(stderr,
-                            "Error: Invalid macro definition '%s' on line %d.\n",
-                            line, count_line);
+                    printPreprocessError(context->origin_file, count_line,
+                                         "Invalid macro definition '%s'",
+                                         line);
                     ret = FAILURE;
                 } else {
-                    currentMacro = new_macro(ptr);
-                    push_back_macro(macroVector, currentMacro);
+                    currentMacro = new_macro(ptr, context->macros);
+                    STATS_COUNT(STAT_MACROS_DEFINED);
+                    push_back_macro(context->macros, currentMacro);
                 }
             } else {
-                fprintf(stderr, "Error: Invalid macro name '%s' on line %d.\n",
-                        ptr, count_line);
+                printPreprocessError(context->origin_file, count_line,
+                                     "Invalid macro name '%s'", ptr);
                 ret = FAILURE;
             }
         } else if (strncmp(ptr, "endmcro", 7) == 0) {
@@ -112,117 +495,352 @@ Status preProcess(const char *input_file, const char *output_file,
                 ptr++;
             }
             if (*ptr != '\0' && *ptr != '\n' && *ptr != '\r') {
-                fprintf(stderr,
-                        "Error: Unexpected characters after 'endmcro' on line %d.\n",
-                        count_line);
+                printPreprocessError(context->origin_file, count_line,
+                                     "Unexpected characters after 'endmcro'",
+                                     NULL);
                 ret = FAILURE;
             }
             currentMacro = NULL;
+            inDefinition = FALSE;
         } else if (currentMacro) {
-            char *command = my_strdup(line);
-            size_t length = strlen(command);
-            if (length > 0 && command[length - 1] == '\n') {
-                command[length - 1] = '\0';
+            /* Tokenize the body line once, every call site will share it */
+            newline = strchr(ptr, '\n');
+            if (newline) {
+                *newline = '\0';
             }
-            push_back(currentMacro->commands, command);
+            push_back(currentMacro->commands,
+                      tokenizeLine(ptr, context->origin_file, count_line,
+                                   context->arena));
+        } else if (!inDefinition && context->includeCache != NULL &&
+                   isIncludeDirective(ptr)) {
+            /* Preprocess the included file (once per run) and make its macros visible */
+            includedFile = findInclude(context, ptr, count_line, TRUE);
+            if (includedFile == NULL) {
+                ret = FAILURE;
+            } else {
+                addIncludedMacros(context->macros, includedFile);
+                if (context->includes != NULL) {
+                    push_back(context->includes, includedFile);
+                }
+            }
+        } else if (macrosOnly && !inDefinition) {
+            printPreprocessError(context->origin_file, count_line,
+                                 "Unexpected line outside of a macro definition",
+                                 NULL);
+            ret = FAILURE;
         }
     }
 
-    /* Rewind the input file to the beginning for the second pass */
-    rewind(inputFile);
+    return ret;
+}
+/******************************************************************************/
+/**
+ * Checks if a line is an '.include' directive.
+ *
+ * @param line - The line, without leading whitespaces.
+ *
+ * @return 1 if the line starts with the '.include' directive; 0 otherwise.
+ */
+int isIncludeDirective(const char *line) {
+    return strncmp(line, ".include", 8) == 0 &&
+           (line[8] == '\0' || isspace((unsigned char) line[8]));
+}
+/******************************************************************************/
+/**
+ * Finds the file named by an '.include "file"' directive, preprocessing it
+ * first if this is the first time it is included in the run.
+ * The path of the included file is relative to the directory of the including file.
+ *
+ * @param context - The file containing the directive.
+ * @param line - The directive line, without leading whitespaces.
+ * @param line_number - The line number of the directive.
+ * @param report - TRUE to report errors. The directive is read in both passes
+ *                 of the preprocessor, and errors are reported only in the first.
+ *
+ * @return The IncludedFile, or NULL if it could not be included.
+ */
+IncludedFile *findInclude(PreprocessContext *context, const char *line,
+                          int line_number, Boolean report) {
+    char path[MAX_SOURCE_LINE_LENGTH * 2];
+    const char *name = line + 8, *name_end = NULL, *directory_end = NULL;
+    size_t directory_length = 0;
+    IncludedFile *includedFile = NULL;
 
-    /* Second pass: output the file, expanding macros */
-    while (fgets(line, sizeof(line), inputFile)) {
-        if (1 == filter_line(line)) {
-            continue;
+    /* The file name must be quoted, and nothing may follow it */
+    while (isspace((unsigned char) *name)) {
+        name++;
+    }
+    name_end = *name == '"' ? strchr(name + 1, '"') : NULL;
+    if (name_end != NULL) {
+        name++;
+        line = name_end + 1;
+        while (isspace((unsigned char) *line)) {
+            line++;
         }
-        ptr = line;
-        /* Skip leading whitespaces */
-        while (isspace((unsigned char) *ptr)) {
-            ptr++;
+    }
+    if (name_end == NULL || name_end == name || *line != '\0') {
+        if (report) {
+            printPreprocessError(context->origin_file, line_number,
+                                 "Invalid include directive", NULL);
         }
+        return NULL;
+    }
 
-        /* Remove the newline at the end of the line, if present */
-        newline = strchr(ptr, '\n');
-        if (newline) {
-            *newline = '\0';
+    /* Resolve the path relative to the directory of the including file */
+    directory_end = strrchr(context->file_name, '/');
+    if (name[0] != '/' && directory_end != NULL) {
+        directory_length = directory_end - context->file_name + 1;
+    }
+    memcpy(path, context->file_name, directory_length);
+    memcpy(path + directory_length, name, name_end - name);
+    path[directory_length + (name_end - name)] = '\0';
+
+    /* The processed file isn't in the include cache, but is in progress like
+     * the included files, so a cycle through it is closed at this directive */
+    includedFile = findIncludedFile(context->includeCache, path);
+    if ((includedFile != NULL && includedFile->state == INCLUDE_IN_PROGRESS) ||
+        (context->processed_file != NULL &&
+         strcmp(path, context->processed_file) == 0)) {
+        if (report) {
+            printPreprocessError(context->origin_file, line_number,
+                                 "Circular include of '%s'", path);
         }
+        return NULL;
+    }
+    if (includedFile == NULL) {
+        /* The errors of a new file, or its failure to open, were reported
+         * by includeFile at their own lines */
+        includedFile = includeFile(context, path, line_number);
+        return includedFile->state == INCLUDE_DONE ? includedFile : NULL;
+    }
 
-        /* If the line starts with a macro definition or end of macro, skip it */
-        if (strncmp(ptr, "mcro", 4) == 0) {
-            do {
-                fgets(line, sizeof(line), inputFile);
-                ptr = line;
-                while (isspace((unsigned char) *ptr)) {
-                    ptr++;
-                }
-                newline = strchr(ptr, '\n');
-                if (newline) {
-                    *newline = '\0';
-                }
-            } while (strncmp(ptr, "endmcro", 7) != 0);
-            continue;
+    /* The file failed when it was first included, and its errors were
+     * reported then */
+    if (includedFile->state != INCLUDE_DONE) {
+        if (report) {
+            printPreprocessError(context->origin_file, line_number,
+                                 "Failed to include '%s'", path);
         }
+        return NULL;
+    }
+    return includedFile;
+}
+/******************************************************************************/
+/**
+ * Preprocesses a file included for the first time in the run and stores the
+ * result in the include cache, to be shared by every file that includes it.
+ *
+ * @param context - The file including the new file.
+ * @param path - The path of the included file.
+ * @param line_number - The line number of the '.include' directive.
+ *
+ * @return The new IncludedFile. Its state is INCLUDE_FAILED if it could not
+ *         be opened or preprocessed, which was already reported.
+ */
+IncludedFile *includeFile(PreprocessContext *context, const char *path,
+                          int line_number) {
+    IncludedFile *includedFile = addIncludedFile(context->includeCache, path);
+    PreprocessContext includedContext;
+    MacroVector *visibleMacros = NULL;
+    FILE *inputFile = fopen(path, "r");
+    SourceReader reader;
+    Status ret = SUCCESS;
+    int i;
 
-        macroToExpand = NULL;
-        /* Iterate through all defined macros */
-        for (i = 0; i < macroVector->size; ++i) {
-            /** If the current line starts with the name of a macro, this indicates
-             * a macro invocation. The macro name is followed by either a space,
-             * newline or null character.
-             *
-             * strncmp is used to compare the first n characters of ptr and macro name,
-             * where n is the length of the macro name. If they are equal, strncmp returns 0.
-             *
-             * If such a macro invocation is detected, the pointer macroToExpand is set to the
-             * current macro, and the loop is exited early.
-             */
-            if (strncmp(ptr, macroVector->macros[i]->name,
-                        strlen(macroVector->macros[i]->name)) == 0 &&
-                (ptr[strlen(macroVector->macros[i]->name)] == ' ' ||
-                 ptr[strlen(macroVector->macros[i]->name)] == '\n' ||
-                 ptr[strlen(macroVector->macros[i]->name)] == '\0')) {
-                macroToExpand = macroVector->macros[i];
-                break;
-            }
+    if (NULL == inputFile) {
+        printPreprocessError(context->origin_file, line_number,
+                             "Failed to open the included file '%s'", path);
+        includedFile->state = INCLUDE_FAILED;
+        return includedFile;
+    }
+
+    /* The included file sees its own macros and those of the files it includes */
+    visibleMacros = includedFile->visibleMacros;
+    includedContext.file_name = includedFile->path;
+    includedContext.origin_file = includedFile->path;
+    includedContext.programState = NULL;
+    includedContext.macros = visibleMacros;
+    includedContext.lines = includedFile->lines;
+    includedContext.arena = includedFile->arena;
+    includedContext.includeCache = context->includeCache;
+    includedContext.includes = includedFile->includes;
+    includedContext.processed_file = context->processed_file;
+
+    reader.file = inputFile;
+    ret = preprocessFile(&reader, &includedContext, NULL);
+    fclose(inputFile);
+
+    /* Keep only the macros defined in the file itself, they are shared from now on */
+    for (i = 0; i < visibleMacros->macros.size; ++i) {
+        if (!visibleMacros->macros.items[i]->isShared) {
+            push_back_macro(includedFile->macros, visibleMacros->macros.items[i]);
         }
+    }
+    share_macros(includedFile->macros);
 
-        if (macroToExpand) {
-            /* Expand the macro */
-            for (i = 0; i < macroToExpand->commands->size; ++i) {
-                char *expandedLine = macroToExpand->commands->items[i];
-                /* Remove leading spaces from expanded line */
-                while (isspace((unsigned char) *expandedLine)) {
-                    expandedLine++;
-                }
-                fputs(expandedLine, outputFile);
-                fputs("\n", outputFile);
+    includedFile->state = SUCCESS == ret ? INCLUDE_DONE : INCLUDE_FAILED;
+    return includedFile;
+}
+/******************************************************************************/
+/**
+ * Adds the macros of an included file, and of the files it includes, to a MacroVector.
+ *
+ * @param macroVector - The MacroVector of the including file.
+ * @param includedFile - The included file.
+ */
+void addIncludedMacros(MacroVector *macroVector, IncludedFile *includedFile) {
+    int i;
+    seed_macro_vector(macroVector, includedFile->macros);
+    for (i = 0; i < includedFile->includes->size; ++i) {
+        addIncludedMacros(macroVector, includedFile->includes->items[i]);
+    }
+}
+/******************************************************************************/
+/**
+ * Returns the expansion of a macro: its lines, with every nested macro call
+ * replaced by the expansion of the invoked macro. Nested calls are looked up
+ * in the scope of the macro. The expansion is computed once, on first use,
+ * and reused by every call site afterwards, so expanding a macro costs only
+ * the number of lines it produces, however deep its nested calls are.
+ *
+ * @param macro - The macro to expand.
+ *
+ * @return The expansion, a Vector of TokenizedLine pointers, or NULL if the
+ *         macro invokes itself (directly or through other macros).
+ */
+Vector *expandMacro(Macro *macro) {
+    int i, j;
+    Macro *nestedMacro = NULL;
+    Vector *nestedExpansion = NULL;
+    TokenizedLine *tokenizedLine = NULL;
+
+    switch (macro->expansionState) {
+        case MACRO_EXPANDED:
+            return macro->expansion;
+        case MACRO_RECURSIVE:
+            return NULL;
+        case MACRO_EXPANDING:
+            /* Reached the macro again while flattening it */
+            return NULL;
+        case MACRO_NOT_EXPANDED:
+            break;
+    }
+
+    macro->expansionState = MACRO_EXPANDING;
+    for (i = 0; i < macro->commands->size; ++i) {
+        tokenizedLine = macro->commands->items[i];
+        nestedMacro = find_macro(macro->scope, tokenizedLine->text);
+        if (nestedMacro != NULL &&
+            nestedMacro->expansionState == MACRO_EXPANDING) {
+            /* Report only the call that closes the cycle */
+            printPreprocessError(tokenizedLine->origin_file,
+                                 tokenizedLine->origin_line,
+                                 "Recursive invocation of macro '%s'",
+                                 nestedMacro->name);
+        }
+        nestedExpansion = nestedMacro != NULL ? expandMacro(nestedMacro) : NULL;
+
+        if (nestedMacro != NULL && nestedExpansion == NULL) {
+            macro->expansionState = MACRO_RECURSIVE;
+            macro->expansion = NULL;
+            return NULL;
+        }
+
+        /* The expansion is copied only once the first nested call is found */
+        if (nestedMacro != NULL && macro->expansion == NULL) {
+            if (macro->flattened == NULL) {
+                macro->flattened = new_vector();
             }
-        } else {
-            /* Otherwise, write the line to the output as is */
-            fputs(ptr, outputFile);
-            fputs("\n", outputFile);
+            reset_vector(macro->flattened);
+            macro->expansion = macro->flattened;
+            for (j = 0; j < i; ++j) {
+                push_back(macro->expansion, macro->commands->items[j]);
+            }
+        }
+        if (nestedMacro != NULL) {
+            for (j = 0; j < nestedExpansion->size; ++j) {
+                push_back(macro->expansion, nestedExpansion->items[j]);
+            }
+        } else if (macro->expansion != NULL) {
+            push_back(macro->expansion, tokenizedLine);
         }
     }
 
-    /* Cleanup: Close files and free allocated memory */
-    fclose(inputFile);
-    fclose(outputFile);
-    for (i = 0; i < macroVector->size; ++i) {
-        free_macro(macroVector->macros[i]);
+    if (macro->expansion == NULL) {
+        macro->expansion = macro->commands;
     }
-    free(macroVector->macros);
-    free(macroVector);
+    macro->expansionState = MACRO_EXPANDED;
+    return macro->expansion;
+}
+/******************************************************************************/
+/**
+ * Expands every macro defined in a file, so that recursive macros are reported
+ * where they are defined, even if they are never invoked. Shared macros were
+ * already expanded by the file or library that defined them.
+ *
+ * @param macroVector - The macros visible in the file.
+ *
+ * @return SUCCESS if none of the macros invokes itself, FAILURE otherwise.
+ */
+Status expandMacros(MacroVector *macroVector) {
+    Status ret = SUCCESS;
+    int i;
 
+    for (i = 0; i < macroVector->macros.size; ++i) {
+        if (!macroVector->macros.items[i]->isShared &&
+            expandMacro(macroVector->macros.items[i]) == NULL) {
+            ret = FAILURE;
+        }
+    }
     return ret;
 }
-
+/******************************************************************************/
+/**
+ * Prints an error found while preprocessing a file.
+ *
+ * @param origin_file - The included file or macro library the error was
+ *                      found in, or NULL for the processed file itself.
+ * @param line_number - The line where the error was encountered.
+ * @param message - The error message, with an optional '%s' for the argument.
+ * @param argument - The argument of the message, or NULL.
+ *
+ * Errors in included files and macro libraries name the file they were found in.
+ */
+void printPreprocessError(const char *origin_file, int line_number,
+                          const char *message, const char *argument) {
+    char errorMessage[MAX_SOURCE_LINE_LENGTH * 3];
+    CountError();
+    if (argument != NULL) {
+        sprintf(errorMessage, message, argument);
+    } else {
+        strcpy(errorMessage, message);
+    }
+    if (origin_file != NULL) {
+        fprintf(stderr, "Error: %s on line %d of %s.\n", errorMessage,
+                line_number, origin_file);
+    } else {
+        fprintf(stderr, "Error: %s on line %d.\n", errorMessage, line_number);
+    }
+}
+/******************************************************************************/
+/**
+ * Checks whether the processed file has reached its error limit (--max-errors).
+ * Included files are cached for the whole run, and macro libraries shared by
+ * all the files, so they are always preprocessed in full.
+ *
+ * @param context - The file being preprocessed.
+ *
+ * @return 1 if the preprocessing of the file should stop, 0 otherwise.
+ */
+int stopAtErrorLimit(const PreprocessContext *context) {
+    return context->programState != NULL && ErrorLimitReached();
+}
 /******************************************************************************/
 /**
  * This function checks if a given word is a reserved keyword in the assembly language.
  *
  * @param word - the word to be checked.
- * @param programState - the current state of the program.
+ * @param programState - the current state of the program, or NULL if there are no labels to check.
  *
  * @return 1 if the word is a reserved keyword; 0 otherwise.
  *
@@ -240,7 +858,7 @@ int isReservedKeyword(char *word, ProgramState *programState) {
     if (isRegister(word)) {
         return 1;
     }
-    if (isLabel(word, programState)) {
+    if (programState != NULL && isLabel(word, programState)) {
         return 1;
     }
     return 0;
@@ -19,13 +19,46 @@
 /**
  * This function performs a preprocessing step on an assembly language input file.
  * It identifies and expands macro definitions and writes the transformed code to an output file.
+ * The tokenized lines of the transformed code are kept in programState->amLines
+ * for the next stages.
  *
  * @param input_file - Path to the assembly language source file.
- * @param output_file - Path to the file where the processed code will be written.
+ * @param output_file - Path to the file where the processed code will be written,
+ *                      or NULL to write no file (--check).
  * @param programState - Current state of the program.
  *
  * Returns SUCCESS if preprocessing completed successfully, and FAILURE otherwise.
  */
 Status preProcess(const char *input_file, const char *output_file,
                   ProgramState *programState);
+
+/**
+ * Preprocesses the contents of a source file held in memory, like preProcess,
+ * but without writing the .am file. Used to assemble a program without file
+ * I/O, e.g. by the fuzzing target.
+ *
+ * @param buffer - The contents of the source file, not necessarily null terminated.
+ * @param size - The number of bytes of the buffer.
+ * @param file_name - The name of the source file, '.include' paths are relative to it.
+ * @param programState - Current state of the program. Without an include cache,
+ *                       '.include' directives aren't allowed and nothing is read.
+ *
+ * Returns SUCCESS if preprocessing completed successfully, and FAILURE otherwise.
+ */
+Status preProcessBuffer(const char *buffer, size_t size,
+                        const char *file_name, ProgramState *programState);
+
+/**
+ * Builds a macro library out of a file that holds only macro definitions.
+ * The names are validated once here, and the library's macros are later shared
+ * by every file of the run through seed_macro_vector.
+ *
+ * @param library_file - Path to the macro library file.
+ * @param library - The MacroVector to store the library's macros in.
+ * @param arena - The arena to allocate the library's tokenized lines from.
+ *
+ * Returns SUCCESS if the library was built successfully, and FAILURE otherwise.
+ */
+Status buildMacroLibrary(const char *library_file, MacroVector *library,
+                         Arena *arena);
 #endif
@@ -0,0 +1,142 @@
+/*********************************FILE__HEADER*********************************\
+* File:					mem_report.c
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			Implementation of the memory report. The statistics of
+*                       all the processed files are added up per stage. The
+*                       maximum resident set size is read from /proc, and is
+*                       reported as unavailable where there is none.
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <string.h>
+
+#include "mem_report.h"
+
+/**************************** Structs  Definitions ****************************/
+/* The allocations accounted to a stage */
+typedef struct {
+    long allocations; /* The number of allocations and reallocations */
+    unsigned long bytes; /* The number of bytes allocated */
+    unsigned long peakLiveBytes; /* The most bytes live during the stage */
+    unsigned long largest; /* The size of the largest allocation */
+} MemStageStats;
+
+/******************* Global variable definitions ******************************/
+static const char *memStageNames[NUM_OF_MEM_STAGES] = {
+        "startup", "preProcess", "checkLabels", "ParseFile", "output",
+        "cleanup"
+};
+
+static MemStageStats memStageStats[NUM_OF_MEM_STAGES];
+static MemStage currentMemStage = MEM_STAGE_STARTUP;
+
+/* The number of bytes allocated and not freed yet, and their peak */
+static unsigned long liveBytes = 0;
+static unsigned long peakLiveBytes = 0;
+
+/************************* Functions  Implementations *************************/
+/**
+ * Sets the stage the next allocations are accounted to.
+ *
+ * @param stage - The stage.
+ */
+void set_mem_stage(MemStage stage) {
+    currentMemStage = stage;
+    /* The memory live when a stage starts counts toward its peak */
+    if (liveBytes > memStageStats[stage].peakLiveBytes) {
+        memStageStats[stage].peakLiveBytes = liveBytes;
+    }
+}
+/******************************************************************************/
+/**
+ * Accounts an allocation, or the new size of a reallocated block, to the
+ * current stage.
+ *
+ * @param old_size - The size of the block before it was reallocated, or 0.
+ * @param size - The number of bytes allocated.
+ */
+void mem_record_allocation(size_t old_size, size_t size) {
+    MemStageStats *stats = &memStageStats[currentMemStage];
+
+    stats->allocations++;
+    stats->bytes += size;
+    if (size > stats->largest) {
+        stats->largest = size;
+    }
+    liveBytes = liveBytes - old_size + size;
+    if (liveBytes > stats->peakLiveBytes) {
+        stats->peakLiveBytes = liveBytes;
+    }
+    if (liveBytes > peakLiveBytes) {
+        peakLiveBytes = liveBytes;
+    }
+}
+/******************************************************************************/
+/**
+ * Accounts a freed block.
+ *
+ * @param size - The number of bytes of the block.
+ */
+void mem_record_free(size_t size) {
+    liveBytes -= size;
+}
+/******************************************************************************/
+/**
+ * Reads the maximum resident set size of the process, in kB.
+ *
+ * @return The maximum resident set size, or -1 if it isn't available.
+ */
+long readMaxRss(void) {
+    char line[128];
+    long maxRss = -1;
+    FILE *status = fopen("/proc/self/status", "r");
+
+    if (status == NULL) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), status) != NULL) {
+        if (strncmp(line, "VmHWM:", 6) == 0) {
+            if (sscanf(line + 6, "%ld", &maxRss) != 1) {
+                maxRss = -1;
+            }
+            break;
+        }
+    }
+    fclose(status);
+    return maxRss;
+}
+/******************************************************************************/
+/**
+ * Prints the allocations of each stage and the maximum resident set size
+ * of the process.
+ *
+ * @param out - The file to print the report to.
+ */
+void print_mem_report(FILE *out) {
+    MemStageStats total = {0, 0, 0, 0};
+    long maxRss = readMaxRss();
+    int i;
+
+    fprintf(out, "Memory report:\n");
+    fprintf(out, "%-12s %12s %14s %16s %12s\n", "stage", "allocations",
+            "bytes", "peak live bytes", "largest");
+    for (i = 0; i < NUM_OF_MEM_STAGES; i++) {
+        fprintf(out, "%-12s %12ld %14lu %16lu %12lu\n", memStageNames[i],
+                memStageStats[i].allocations, memStageStats[i].bytes,
+                memStageStats[i].peakLiveBytes, memStageStats[i].largest);
+        total.allocations += memStageStats[i].allocations;
+        total.bytes += memStageStats[i].bytes;
+        if (memStageStats[i].largest > total.largest) {
+            total.largest = memStageStats[i].largest;
+        }
+    }
+    fprintf(out, "%-12s %12ld %14lu %16lu %12lu\n", "total",
+            total.allocations, total.bytes, peakLiveBytes, total.largest);
+    if (maxRss >= 0) {
+        fprintf(out, "max RSS: %ld kB\n", maxRss);
+    } else {
+        fprintf(out, "max RSS: not available\n");
+    }
+}
+/******************************************************************************/
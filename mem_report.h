@@ -0,0 +1,64 @@
+/*********************************FILE__HEADER*********************************\
+* File:					mem_report.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			API of the memory report (--mem-report). The allocations
+*                       made by my_malloc and my_realloc, and the frees made by
+*                       my_free, are accounted to the stage of the assembler
+*                       running at the time, and the report lists for each
+*                       stage its allocations, their bytes, the peak of the
+*                       live bytes and the largest allocation, followed by
+*                       the maximum resident set size of the process.
+\******************************************************************************/
+
+#ifndef MAMAN14_MEM_REPORT_H
+#define MAMAN14_MEM_REPORT_H
+
+#include <stdio.h>
+#include <stddef.h> /* for size_t */
+
+/***************************** Enums  Definitions *****************************/
+/* The stages of the assembler that allocations are accounted to */
+typedef enum {
+    MEM_STAGE_STARTUP, /* Parsing the options and building the macro library */
+    MEM_STAGE_PRE_PROCESS,
+    MEM_STAGE_CHECK_LABELS,
+    MEM_STAGE_PARSE, /* ParseFile and ResolveFixups */
+    MEM_STAGE_OUTPUT, /* Writing the output files */
+    MEM_STAGE_CLEANUP,
+    NUM_OF_MEM_STAGES
+} MemStage;
+
+/************************* Functions Declarations *************************/
+/**
+ * Sets the stage the next allocations are accounted to.
+ *
+ * @param stage - The stage.
+ */
+void set_mem_stage(MemStage stage);
+
+/**
+ * Accounts an allocation, or the new size of a reallocated block, to the
+ * current stage.
+ *
+ * @param old_size - The size of the block before it was reallocated, or 0.
+ * @param size - The number of bytes allocated.
+ */
+void mem_record_allocation(size_t old_size, size_t size);
+
+/**
+ * Accounts a freed block.
+ *
+ * @param size - The number of bytes of the block.
+ */
+void mem_record_free(size_t size);
+
+/**
+ * Prints the allocations of each stage and the maximum resident set size
+ * of the process.
+ *
+ * @param out - The file to print the report to.
+ */
+void print_mem_report(FILE *out);
+
+#endif
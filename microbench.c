@@ -0,0 +1,408 @@
+/*********************************FILE__HEADER*********************************\
+* File:                 microbench.c
+* Authors:              Daniel Brodsky & Lior Katav
+* Date:                 August-2023
+* Description:          This file is a microbenchmark of the hot functions of
+*                       the assembler, separate from the assembler itself. It
+*                       is linked with the sources of the assembler and calls
+*                       each function directly, so its time is measured apart
+*                       from the reading and writing of files.
+*
+*                       Each benchmark runs a batch of calls, calibrated to
+*                       take at least MIN_SAMPLE_SECONDS, for the warm-up
+*                       samples and then for the measured samples, and the
+*                       median and 99th percentile of the time of a call in
+*                       the samples are reported.
+*
+*                       Usage: microbench [--samples <n>] [--warmup <n>]
+*                                         [<name filter>]
+*                       Only the benchmarks whose name contains the filter
+*                       are run.
+\******************************************************************************/
+
+/* For clock_gettime, the rest of the file is C89 */
+#define _POSIX_C_SOURCE 199309L
+
+/******************************** Header Files ********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "program_constants.h"
+#include "param_validation.h"
+#include "label_processing.h"
+#include "binary_and_ob_processing.h"
+#include "output_encoders.h"
+#include "line_tokenizer.h"
+#include "word_image.h"
+#include "vector.h"
+#include "arena.h"
+#include "utils.h"
+
+/******************************** Definitions *********************************/
+#define DEFAULT_SAMPLES 100
+#define DEFAULT_WARMUP 10
+
+/* The shortest time of a sample, so the clock's resolution doesn't matter */
+#define MIN_SAMPLE_SECONDS 0.001
+
+/* The words of the image encoded by the base64 benchmark */
+#define ENCODED_WORDS 1000
+
+/* The number of names looked up in turn by the label benchmarks */
+#define LOOKUP_NAMES 64
+
+/**************************** Structs  Definitions ****************************/
+/* A benchmark: its setup, run once before it is measured, and its batch */
+typedef struct {
+    const char *name;
+    void (*setup)(long parameter);
+    void (*run)(long iterations);
+    long parameter; /* The number of labels, or the index of a line */
+} Benchmark;
+
+/**************************** Forward Declarations ****************************/
+void setupLabels(long count);
+
+void setupLine(long index);
+
+void setupEncoder(long unused);
+
+void runFindCommand(long iterations);
+
+void runFindInstruction(long iterations);
+
+void runIsRegister(long iterations);
+
+void runFindRegister(long iterations);
+
+void runIsLabel(long iterations);
+
+void runGetLabelIndex(long iterations);
+
+void runEncodeBase64(long iterations);
+
+void runProcessLine(long iterations);
+
+/******************* Global variable definitions ******************************/
+/* The lines processed by the line benchmarks, one of each operand shape */
+static const char *benchLines[] = {
+        "stop",
+        "inc @r1",
+        "prn -5",
+        "jmp L1",
+        "mov @r1, @r2",
+        "add 5, L1",
+        "lea L1, @r3",
+        "L2: cmp L3, -7",
+        ".data 6, -9, 15",
+        ".string \"abcdef\""
+};
+
+static const Benchmark benchmarks[] = {
+        {"findCommand",            NULL,         runFindCommand,     0},
+        {"findInstruction",        NULL,         runFindInstruction, 0},
+        {"isRegister",             NULL,         runIsRegister,      0},
+        {"findRegister",           NULL,         runFindRegister,    0},
+        {"isLabel/10",             setupLabels,  runIsLabel,         10},
+        {"isLabel/1k",             setupLabels,  runIsLabel,         1000},
+        {"isLabel/100k",           setupLabels,  runIsLabel,         100000},
+        {"getLabelIndex/10",       setupLabels,  runGetLabelIndex,   10},
+        {"getLabelIndex/1k",       setupLabels,  runGetLabelIndex,   1000},
+        {"getLabelIndex/100k",     setupLabels,  runGetLabelIndex,   100000},
+        {"encodeBase64/1k",        setupEncoder, runEncodeBase64,    0},
+        {"line/stop",              setupLine,    runProcessLine,     0},
+        {"line/register",          setupLine,    runProcessLine,     1},
+        {"line/immediate",         setupLine,    runProcessLine,     2},
+        {"line/label",             setupLine,    runProcessLine,     3},
+        {"line/register-pair",     setupLine,    runProcessLine,     4},
+        {"line/immediate-label",   setupLine,    runProcessLine,     5},
+        {"line/label-register",    setupLine,    runProcessLine,     6},
+        {"line/labeled-immediate", setupLine,    runProcessLine,     7},
+        {"line/data",              setupLine,    runProcessLine,     8},
+        {"line/string",            setupLine,    runProcessLine,     9}
+};
+static const int benchmarksSize = sizeof(benchmarks) / sizeof(Benchmark);
+
+/* The program state the functions are called with */
+static ProgramState benchState;
+
+/* The names the label benchmarks look up, spread over the labels */
+static char lookupNames[LOOKUP_NAMES][MAX_LABEL_LENGTH];
+
+/* The line processed by the line benchmark */
+static const char *benchLine = NULL;
+
+/* The encoder and the file of the base64 benchmark */
+static const OutputEncoder *base64Encoder = NULL;
+static FILE *encodedFile = NULL;
+
+/* The results of the calls, so they aren't optimized away */
+static volatile long sink = 0;
+
+/************************* Functions  Implementations *************************/
+/**
+ * Returns the wall time, in seconds from an arbitrary point.
+ */
+double benchSeconds(void) {
+#ifdef CLOCK_MONOTONIC
+    struct timespec now;
+    if (clock_gettime(CLOCK_MONOTONIC, &now) == 0) {
+        return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+    }
+#endif
+    return (double) clock() / CLOCKS_PER_SEC;
+}
+/******************************************************************************/
+/**
+ * Fills the labels of the program state with the given number of labels, and
+ * picks the names to look up: labels spread from the first to the last, and
+ * a name that isn't a label.
+ *
+ * @param count - The number of labels.
+ */
+void setupLabels(long count) {
+    Label label;
+    long i;
+
+    memset(&label, 0, sizeof(label));
+    label_vector_clear(&benchState.labels);
+    name_index_clear(&benchState.labelIndex);
+    for (i = 0; i < count; i++) {
+        sprintf(label.name, "L%ld", i);
+        label.line_number = (int) i;
+        AddLabel(&label, &benchState);
+    }
+    for (i = 0; i < LOOKUP_NAMES - 1; i++) {
+        sprintf(lookupNames[i], "L%ld", i * (count - 1) / (LOOKUP_NAMES - 2));
+    }
+    strcpy(lookupNames[LOOKUP_NAMES - 1], "MISSING");
+}
+/******************************************************************************/
+/**
+ * Selects the line of the line benchmark. The labels it refers to are
+ * defined, and the line is processed as a line of a two pass assembly.
+ *
+ * @param index - The index of the line in benchLines.
+ */
+void setupLine(long index) {
+    setupLabels(10);
+    benchLine = benchLines[index];
+}
+/******************************************************************************/
+/**
+ * Fills the code and data images with the words encoded by the base64
+ * benchmark, and opens the temporary file it writes them to.
+ *
+ * @param unused - Unused.
+ */
+void setupEncoder(long unused) {
+    int i;
+
+    reset_word_image(benchState.code);
+    reset_word_image(benchState.data);
+    for (i = 0; i < ENCODED_WORDS; i++) {
+        push_word(i % 4 == 0 ? benchState.data : benchState.code,
+                  (i * 2654435761UL) & 0xFFF);
+    }
+    base64Encoder = getOutputEncoder(findOutputEncoder("base64"));
+    if (encodedFile == NULL && (encodedFile = tmpfile()) == NULL) {
+        printf("Failed to open a temporary file.\n");
+        exit(1);
+    }
+}
+/******************************************************************************/
+void runFindCommand(long iterations) {
+    static const char *names[] = {"mov", "STOP", "Prn", "rts", "data", "xyz"};
+    char name[8];
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        /* findCommand lowercases its argument */
+        strcpy(name, names[i % 6]);
+        sink += findCommand(name);
+    }
+}
+/******************************************************************************/
+void runFindInstruction(long iterations) {
+    static const char *names[] = {".data", ".string", ".entry", ".extern",
+                                  "mov"};
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        sink += findInstruction(names[i % 5]);
+    }
+}
+/******************************************************************************/
+void runIsRegister(long iterations) {
+    static const char *names[] = {"@r1", "@r4", "@r7", "@r9", "r3", "LOOP"};
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        sink += isRegister(names[i % 6]);
+    }
+}
+/******************************************************************************/
+void runFindRegister(long iterations) {
+    static const char *names[] = {"@r1", "@r4", "@r7", "@r9"};
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        sink += findRegister(names[i % 4]);
+    }
+}
+/******************************************************************************/
+void runIsLabel(long iterations) {
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        sink += isLabel(lookupNames[i % LOOKUP_NAMES], &benchState);
+    }
+}
+/******************************************************************************/
+void runGetLabelIndex(long iterations) {
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        sink += getLabelIndex(lookupNames[i % LOOKUP_NAMES], &benchState);
+    }
+}
+/******************************************************************************/
+void runEncodeBase64(long iterations) {
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        rewind(encodedFile);
+        base64Encoder->encode(benchState.code, benchState.data, encodedFile);
+    }
+    sink += ftell(encodedFile);
+}
+/******************************************************************************/
+/**
+ * Tokenizes, decodes and encodes the line of the benchmark, as ParseFile
+ * does for each line. The images, fixups and arena are emptied before the
+ * batch, keeping their memory.
+ */
+void runProcessLine(long iterations) {
+    TokenizedLine *line;
+    Statement statement;
+    long i;
+
+    reset_word_image(benchState.code);
+    reset_word_image(benchState.data);
+    reset_vector(benchState.fixups);
+    reset_arena(benchState.arena);
+    for (i = 0; i < iterations; i++) {
+        line = tokenizeLine(benchLine, NULL, 1, benchState.arena);
+        if (SUCCESS == DecodeLine(line, 1, &statement, &benchState)) {
+            EncodeStatement(&statement, &benchState);
+        }
+    }
+    sink += benchState.code->size + benchState.data->size;
+}
+/******************************************************************************/
+int compareDoubles(const void *first, const void *second) {
+    double a = *(const double *) first, b = *(const double *) second;
+    return a < b ? -1 : a > b;
+}
+/******************************************************************************/
+/**
+ * Runs a benchmark and prints the median and 99th percentile of the time of
+ * a call.
+ *
+ * @param benchmark - The benchmark.
+ * @param numOfSamples - The number of measured samples.
+ * @param warmup - The number of samples run before the measured ones.
+ */
+void runBenchmark(const Benchmark *benchmark, int numOfSamples, int warmup) {
+    double *samples = my_malloc(sizeof(double) * numOfSamples);
+    double start, seconds;
+    long iterations = 1;
+    int i;
+
+    if (samples == NULL) {
+        printf("Error: Memory allocation for the samples failed!\n");
+        exit(1);
+    }
+    if (benchmark->setup != NULL) {
+        benchmark->setup(benchmark->parameter);
+    }
+
+    /* The batch doubles until a sample is long enough to be measured */
+    for (;;) {
+        start = benchSeconds();
+        benchmark->run(iterations);
+        if (benchSeconds() - start >= MIN_SAMPLE_SECONDS) {
+            break;
+        }
+        iterations *= 2;
+    }
+    for (i = 0; i < warmup; i++) {
+        benchmark->run(iterations);
+    }
+    for (i = 0; i < numOfSamples; i++) {
+        start = benchSeconds();
+        benchmark->run(iterations);
+        seconds = benchSeconds() - start;
+        samples[i] = seconds * 1e9 / (double) iterations;
+    }
+    qsort(samples, numOfSamples, sizeof(double), compareDoubles);
+
+    printf("%-24s %12.1f %12.1f %12ld\n", benchmark->name,
+           samples[numOfSamples / 2],
+           samples[(numOfSamples * 99 + 99) / 100 - 1], iterations);
+    my_free(samples);
+}
+/******************************************************************************/
+int main(int argc, char *argv[]) {
+    const char *filter = NULL;
+    int numOfSamples = DEFAULT_SAMPLES, warmup = DEFAULT_WARMUP;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            numOfSamples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && filter == NULL) {
+            filter = argv[i];
+        } else {
+            fprintf(stderr, "Usage: %s [--samples <n>] [--warmup <n>] "
+                            "[<name filter>]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (numOfSamples < 1 || warmup < 0) {
+        fprintf(stderr, "microbench: Invalid number of samples\n");
+        return 1;
+    }
+
+    memset(&benchState, 0, sizeof(benchState));
+    benchState.arena = new_arena();
+    label_vector_init(&benchState.labels, NULL);
+    name_index_init(&benchState.labelIndex);
+    label_vector_init(&benchState.externalLabels, benchState.arena);
+    benchState.code = new_word_image();
+    benchState.data = new_word_image();
+    benchState.fixups = new_vector();
+
+    printf("%-24s %12s %12s %12s\n", "benchmark", "median ns", "p99 ns",
+           "calls/sample");
+    for (i = 0; i < benchmarksSize; i++) {
+        if (filter == NULL || strstr(benchmarks[i].name, filter) != NULL) {
+            runBenchmark(&benchmarks[i], numOfSamples, warmup);
+        }
+    }
+
+    if (encodedFile != NULL) {
+        fclose(encodedFile);
+    }
+    label_vector_free(&benchState.labels);
+    name_index_free(&benchState.labelIndex);
+    free_word_image(benchState.code);
+    free_word_image(benchState.data);
+    free_vector_shallow(benchState.fixups);
+    free_arena(benchState.arena);
+    return 0;
+}
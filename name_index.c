@@ -0,0 +1,165 @@
+/*********************************FILE__HEADER*********************************\
+* File:					name_index.c
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			Implementation of the NameIndex, an open addressing hash
+*                       table with linear probing. The table is doubled before
+*                       it is half full, so the items with the same hash are
+*                       found in a few consecutive entries.
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "name_index.h"
+#include "utils.h" /* for my_malloc */
+
+/******************************** Definitions *********************************/
+/* The number of entries of the table when it is first allocated */
+#define NAME_INDEX_INITIAL_CAPACITY 64
+
+/**************************** Forward Declarations ****************************/
+void placeEntry(NameIndex *index, unsigned long hash, int value);
+
+/************************* Functions  Implementations *************************/
+/**
+ * Returns the FNV-1a hash of a name.
+ *
+ * @param name - The name.
+ * @param length - The length of the name.
+ * @return The hash of the name.
+ */
+unsigned long name_hash(const char *name, size_t length) {
+    unsigned long hash = 2166136261UL;
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        hash = ((hash ^ (unsigned char) name[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return hash;
+}
+/******************************************************************************/
+/**
+ * Initializes an empty index, its table is allocated on the first insert.
+ *
+ * @param index - The index.
+ */
+void name_index_init(NameIndex *index) {
+    index->entries = NULL;
+    index->size = 0;
+    index->capacity = 0;
+}
+/******************************************************************************/
+/**
+ * Puts an item in the first empty entry from the home entry of its hash.
+ */
+void placeEntry(NameIndex *index, unsigned long hash, int value) {
+    int slot = (int) (hash & (unsigned long) (index->capacity - 1));
+
+    while (index->entries[slot].value != -1) {
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+    index->entries[slot].hash = hash;
+    index->entries[slot].value = value;
+}
+/******************************************************************************/
+/**
+ * Adds the index of an item to the index, doubling the table first if it
+ * would be more than half full.
+ *
+ * @param index - The index.
+ * @param hash - The hash of the name of the item.
+ * @param value - The index of the item.
+ */
+void name_index_insert(NameIndex *index, unsigned long hash, int value) {
+    NameIndexEntry *old_entries = index->entries;
+    int old_capacity = index->capacity, i;
+
+    if ((index->size + 1) * 2 > index->capacity) {
+        index->capacity = old_capacity > 0 ? old_capacity * 2
+                                           : NAME_INDEX_INITIAL_CAPACITY;
+        index->entries = my_malloc(sizeof(NameIndexEntry) * index->capacity);
+        if (index->entries == NULL) {
+            fprintf(stderr, "Error allocating memory for a name index\n");
+            exit(1);
+        }
+        for (i = 0; i < index->capacity; i++) {
+            index->entries[i].value = -1;
+        }
+        for (i = 0; i < old_capacity; i++) {
+            if (old_entries[i].value != -1) {
+                placeEntry(index, old_entries[i].hash, old_entries[i].value);
+            }
+        }
+        my_free(old_entries);
+    }
+    placeEntry(index, hash, value);
+    index->size++;
+}
+/******************************************************************************/
+/**
+ * Returns the slot to start walking the items with the given hash from.
+ *
+ * @param index - The index.
+ * @param hash - The hash of the name.
+ * @return The slot to pass to name_index_next.
+ */
+int name_index_start(const NameIndex *index, unsigned long hash) {
+    return index->capacity > 0
+           ? (int) (hash & (unsigned long) (index->capacity - 1)) : 0;
+}
+/******************************************************************************/
+/**
+ * Returns the next item with the given hash, and advances the slot past it.
+ *
+ * @param index - The index.
+ * @param hash - The hash of the name.
+ * @param slot - The slot, from name_index_start.
+ * @return The index of the item, or -1 if there are no more items.
+ */
+int name_index_next(const NameIndex *index, unsigned long hash, int *slot) {
+    const NameIndexEntry *entry;
+
+    if (index->capacity == 0) {
+        return -1;
+    }
+    for (;;) {
+        entry = &index->entries[*slot];
+        if (entry->value == -1) {
+            return -1;
+        }
+        *slot = (*slot + 1) & (index->capacity - 1);
+        if (entry->hash == hash) {
+            return entry->value;
+        }
+    }
+}
+/******************************************************************************/
+/**
+ * Empties the index, keeping its table for the next items.
+ *
+ * @param index - The index.
+ */
+void name_index_clear(NameIndex *index) {
+    int i;
+
+    if (index->size == 0) {
+        return;
+    }
+    for (i = 0; i < index->capacity; i++) {
+        index->entries[i].value = -1;
+    }
+    index->size = 0;
+}
+/******************************************************************************/
+/**
+ * Frees the table of the index.
+ *
+ * @param index - The index.
+ */
+void name_index_free(NameIndex *index) {
+    my_free(index->entries);
+    name_index_init(index);
+}
+/******************************************************************************/
@@ -0,0 +1,102 @@
+/*********************************FILE__HEADER*********************************\
+* File:					name_index.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			API of the NameIndex, a hash table from the names of the
+*                       items of a vector (labels or macros) to their indices,
+*                       so that an item is found by its name without comparing
+*                       it to every name of the vector.
+*
+*                       The index holds only the hashes and the indices, not the
+*                       names, which may move when their vector grows: the
+*                       caller walks the indices of the items whose name has the
+*                       same hash, and compares their names itself:
+*
+*                           slot = name_index_start(index, hash);
+*                           while ((i = name_index_next(index, hash, &slot)) != -1)
+*                               if (strcmp(name, items[i].name) == 0) ...
+*
+*                       Several items may have the same name, each of them is
+*                       walked.
+\******************************************************************************/
+
+#ifndef MAMAN14_NAME_INDEX_H
+#define MAMAN14_NAME_INDEX_H
+
+#include <stddef.h> /* for size_t */
+
+/**************************** Structs  Definitions ****************************/
+/* An entry of the table: the hash of a name and the index of its item */
+typedef struct {
+    unsigned long hash;
+    int value; /* The index of the item, or -1 for an empty entry */
+} NameIndexEntry;
+
+/* An open addressing hash table, at most half full */
+typedef struct {
+    NameIndexEntry *entries;
+    int size; /* The number of indexed items */
+    int capacity; /* The number of entries, a power of 2, or 0 */
+} NameIndex;
+
+/************************* Functions Declarations *************************/
+/**
+ * Returns the hash of a name.
+ *
+ * @param name - The name.
+ * @param length - The length of the name.
+ * @return The hash of the name.
+ */
+unsigned long name_hash(const char *name, size_t length);
+
+/**
+ * Initializes an empty index, its table is allocated on the first insert.
+ *
+ * @param index - The index.
+ */
+void name_index_init(NameIndex *index);
+
+/**
+ * Adds the index of an item to the index.
+ * In case of an memory allocation error the program will exit.
+ *
+ * @param index - The index.
+ * @param hash - The hash of the name of the item.
+ * @param value - The index of the item.
+ */
+void name_index_insert(NameIndex *index, unsigned long hash, int value);
+
+/**
+ * Returns the slot to start walking the items with the given hash from.
+ *
+ * @param index - The index.
+ * @param hash - The hash of the name.
+ * @return The slot to pass to name_index_next.
+ */
+int name_index_start(const NameIndex *index, unsigned long hash);
+
+/**
+ * Returns the next item with the given hash, and advances the slot past it.
+ *
+ * @param index - The index.
+ * @param hash - The hash of the name.
+ * @param slot - The slot, from name_index_start.
+ * @return The index of the item, or -1 if there are no more items.
+ */
+int name_index_next(const NameIndex *index, unsigned long hash, int *slot);
+
+/**
+ * Empties the index, keeping its table for the next items.
+ *
+ * @param index - The index.
+ */
+void name_index_clear(NameIndex *index);
+
+/**
+ * Frees the table of the index.
+ *
+ * @param index - The index.
+ */
+void name_index_free(NameIndex *index);
+
+#endif
@@ -0,0 +1,170 @@
+/*********************************FILE__HEADER*********************************\
+* File:                 options.c
+* Authors:              Daniel Brodsky & Lior Katav
+* Date:                 August-2023
+* Description:          This file contains the parsing of the assembler's
+*                       command-line arguments. Arguments starting with "--"
+*                       are options, all the others are names of files to
+*                       process.
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "options.h"
+#include "output_encoders.h"
+#include "stats.h"
+
+/******************************** Definitions *********************************/
+/* The longest name of an output format, including the '\0' */
+#define MAX_FORMAT_NAME_LENGTH 16
+
+/************************* Functions  Implementations *************************/
+/**
+ * Selects the output formats of a comma separated list of format names.
+ *
+ * @param formats - The list of format names, e.g. "base64,ihex".
+ * @param options - The Options struct to select the formats in.
+ *
+ * @return SUCCESS if all the formats exist, FAILURE otherwise.
+ */
+Status parseFormats(const char *formats, Options *options) {
+    char name[MAX_FORMAT_NAME_LENGTH];
+    const char *end;
+    size_t length;
+    int formatIdx;
+
+    while (*formats) {
+        end = strchr(formats, ',');
+        length = end != NULL ? (size_t) (end - formats) : strlen(formats);
+        formatIdx = -1;
+        if (length < sizeof(name)) {
+            memcpy(name, formats, length);
+            name[length] = '\0';
+            formatIdx = findOutputEncoder(name);
+        }
+        if (formatIdx == -1) {
+            printf("Error: Unknown output format '%.*s'.\n", (int) length,
+                   formats);
+            return FAILURE;
+        }
+        options->output_formats |= 1U << formatIdx;
+        formats += length + (end != NULL);
+    }
+    return SUCCESS;
+}
+/******************************************************************************/
+/**
+ * Parses the command-line arguments. Options may appear anywhere among the
+ * file names, and an option that takes a value reads it from the next argument.
+ *
+ * @param argc - The number of command-line arguments.
+ * @param argv - The command-line arguments.
+ * @param options - The Options struct to fill.
+ *
+ * @return SUCCESS if all the arguments are valid, FAILURE otherwise.
+ */
+Status parseOptions(int argc, char *argv[], Options *options) {
+    char *end;
+    int i;
+
+    options->macro_lib_file = NULL;
+    options->one_pass = 0;
+    options->binary_object = 0;
+    options->output_formats = 0;
+    options->mem_report = 0;
+    options->stats = STATS_OFF;
+    options->stats_file = NULL;
+    options->hw_counters = 0;
+    options->trace_file = NULL;
+    options->check = 0;
+    options->max_errors = 0;
+    options->num_of_files = 0;
+    options->file_names = my_malloc(sizeof(char *) * argc);
+    if (options->file_names == NULL) {
+        printf("Error: Memory allocation for the options was failed!\n");
+        exit(1);
+    }
+
+    for (i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0) {
+            options->file_names[options->num_of_files++] = argv[i];
+        } else if (strcmp(argv[i], "--macro-lib") == 0) {
+            if (i + 1 >= argc) {
+                printf("Error: Option '%s' requires a file name.\n", argv[i]);
+                return FAILURE;
+            }
+            options->macro_lib_file = argv[++i];
+        } else if (strcmp(argv[i], "--one-pass") == 0) {
+            options->one_pass = 1;
+        } else if (strcmp(argv[i], "--binary-object") == 0) {
+            options->binary_object = 1;
+        } else if (strcmp(argv[i], "--mem-report") == 0) {
+            options->mem_report = 1;
+        } else if (strcmp(argv[i], "--stats") == 0 ||
+                   strcmp(argv[i], "--stats=text") == 0) {
+            options->stats = STATS_TEXT;
+        } else if (strncmp(argv[i], "--stats=json", 12) == 0) {
+            /* The JSON goes to a file of its own, away from the messages */
+            if (argv[i][12] != ':' || argv[i][13] == '\0') {
+                printf("Error: Option '--stats=json' requires a file name, "
+                       "as in '--stats=json:<file>'.\n");
+                return FAILURE;
+            }
+            options->stats = STATS_JSON;
+            options->stats_file = argv[i] + 13;
+        } else if (strcmp(argv[i], "--hw-counters") == 0) {
+            options->hw_counters = 1;
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            if (i + 1 >= argc) {
+                printf("Error: Option '%s' requires a file name.\n", argv[i]);
+                return FAILURE;
+            }
+            options->trace_file = argv[++i];
+        } else if (strcmp(argv[i], "--check") == 0) {
+            options->check = 1;
+        } else if (strcmp(argv[i], "--fail-fast") == 0) {
+            options->max_errors = 1;
+        } else if (strcmp(argv[i], "--max-errors") == 0) {
+            if (i + 1 >= argc) {
+                printf("Error: Option '%s' requires a number.\n", argv[i]);
+                return FAILURE;
+            }
+            options->max_errors = strtol(argv[++i], &end, 10);
+            /* 0 is the default of no limit, so the limit is at least 1 */
+            if (end == argv[i] || *end != '\0' || options->max_errors < 1) {
+                printf("Error: Invalid number of errors '%s'.\n", argv[i]);
+                return FAILURE;
+            }
+        } else if (strcmp(argv[i], "--format") == 0) {
+            if (i + 1 >= argc) {
+                printf("Error: Option '%s' requires a format name.\n", argv[i]);
+                return FAILURE;
+            }
+            if (SUCCESS != parseFormats(argv[++i], options)) {
+                return FAILURE;
+            }
+        } else {
+            printf("Error: Unknown option '%s'.\n", argv[i]);
+            return FAILURE;
+        }
+    }
+    if (options->output_formats == 0) {
+        options->output_formats = 1U << findOutputEncoder("base64");
+    }
+    return SUCCESS;
+}
+/******************************************************************************/
+/**
+ * Frees the memory allocated by parseOptions.
+ *
+ * @param options - The Options struct to free.
+ */
+void freeOptions(Options *options) {
+    my_free(options->file_names);
+    options->file_names = NULL;
+    options->num_of_files = 0;
+}
+/******************************************************************************/
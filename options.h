@@ -0,0 +1,52 @@
+/*********************************FILE__HEADER*********************************\
+* File:					options.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			This header file provides the Options struct, which holds
+*                       the command-line options of the assembler and the names
+*                       of the files to process, and the function that parses them.
+\******************************************************************************/
+
+#ifndef MAMAN14_OPTIONS_H
+#define MAMAN14_OPTIONS_H
+
+#include "utils.h" /* for the Status enum */
+
+/**************************** Structs  Definitions ****************************/
+/* Struct holding the command-line options of the assembler */
+typedef struct {
+    char *macro_lib_file; /* File of macros shared by all files (--macro-lib), or NULL */
+    int one_pass; /* Define labels while encoding, without a separate label pass (--one-pass) */
+    int binary_object; /* Also write a packed binary object file (--binary-object) */
+    unsigned int output_formats; /* Bit i selects output encoder i (--format), base64 by default */
+    int mem_report; /* Print the allocations of each stage at exit (--mem-report) */
+    int stats; /* The StatsFormat of the timings and counters of the run (--stats) */
+    char *stats_file; /* File to write the JSON statistics to (--stats=json:<file>), or NULL */
+    int hw_counters; /* Count the cycles, instructions and misses of each stage (--hw-counters) */
+    char *trace_file; /* File to write the trace of the files and stages to (--trace), or NULL */
+    int check; /* Only report the errors, without encoding or writing any file (--check) */
+    long max_errors; /* Stop processing a file at this many errors (--max-errors, --fail-fast), 0 for no limit */
+    char **file_names; /* The names of the files to process, without extensions */
+    int num_of_files; /* The number of files to process */
+} Options;
+
+/******************************************************************************/
+/**
+ * Parses the command-line arguments into options and file names.
+ *
+ * @param argc - The number of command-line arguments.
+ * @param argv - The command-line arguments.
+ * @param options - The Options struct to fill.
+ *
+ * @return SUCCESS if all the arguments are valid, FAILURE otherwise.
+ */
+Status parseOptions(int argc, char *argv[], Options *options);
+
+/**
+ * Frees the memory allocated by parseOptions.
+ *
+ * @param options - The Options struct to free.
+ */
+void freeOptions(Options *options);
+
+#endif
@@ -0,0 +1,243 @@
+/*********************************FILE__HEADER*********************************\
+* File:                 output_encoders.c
+* Authors:              Daniel Brodsky & Lior Katav
+* Date:                 August-2023
+* Description:          This file contains the output encoders of the assembler.
+*                       Each encoder writes the code and data images of a
+*                       program, loaded from START_ADDRESS, in one format:
+*                       base64 - The .ob file, "IC DC" and then two base64
+*                                characters for each word.
+*                       hex    - A hex dump, "IC DC" and then the decimal
+*                                address and the 3 hex digits of each word.
+*                       raw    - The words as 16-bit little-endian integers.
+*                       ihex   - Intel HEX records of the words as 16-bit
+*                                little-endian integers, each word at twice
+*                                its address.
+*                       The encoders are selected by name from a table.
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <string.h>
+#include <stdlib.h>
+
+#include "output_encoders.h"
+#include "stats.h"
+
+/**************************** Forward Declarations ****************************/
+void encodeBase64(const WordImage *code, const WordImage *data,
+                  FILE *outputFile);
+
+void encodeHex(const WordImage *code, const WordImage *data, FILE *outputFile);
+
+void encodeRaw(const WordImage *code, const WordImage *data, FILE *outputFile);
+
+void encodeIntelHex(const WordImage *code, const WordImage *data,
+                    FILE *outputFile);
+
+/******************* Global variable definitions ******************************/
+/* The supported output formats, base64 is the default */
+static const OutputEncoder outputEncoders[] = {
+        {"base64", ".ob",  "w",  encodeBase64},
+        {"hex",    ".hex", "w",  encodeHex},
+        {"raw",    ".raw", "wb", encodeRaw},
+        {"ihex",   ".ihx", "w",  encodeIntelHex}
+};
+static const int outputEncodersSize =
+        sizeof(outputEncoders) / sizeof(OutputEncoder);
+
+/* The digit of each 6-bit value in base64, and of each 4-bit value in hex */
+static const char base64Digits[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char hexDigits[] = "0123456789ABCDEF";
+
+/************************* Functions  Implementations *************************/
+/**
+ * Returns the word of the program at the given index: the instruction words
+ * are followed by the data words.
+ *
+ * @param code - The instruction words of the program.
+ * @param data - The data words of the program.
+ * @param index - The index of the word, from 0.
+ * @return The word.
+ */
+unsigned int wordAt(const WordImage *code, const WordImage *data, int index) {
+    return index < code->size ? code->words[index]
+                              : data->words[index - code->size];
+}
+/******************************************************************************/
+/**
+ * Writes each word as two base64 characters, its upper and lower 6 bits.
+ */
+void encodeBase64(const WordImage *code, const WordImage *data,
+                  FILE *outputFile) {
+    int i, total = code->size + data->size;
+    unsigned int word;
+    char digits[3];
+
+    digits[2] = '\n';
+    fprintf(outputFile, "%d %d\n", code->size, data->size);
+    for (i = 0; i < total; i++) {
+        word = wordAt(code, data, i);
+        digits[0] = base64Digits[word >> 6];
+        digits[1] = base64Digits[word & 0x3F];
+        fwrite(digits, 1, sizeof(digits), outputFile);
+    }
+}
+/******************************************************************************/
+/**
+ * Writes the decimal address and the 3 hex digits of each word, one per line.
+ */
+void encodeHex(const WordImage *code, const WordImage *data, FILE *outputFile) {
+    int i, total = code->size + data->size;
+    unsigned int word;
+    char digits[4];
+
+    digits[3] = '\n';
+    fprintf(outputFile, "%d %d\n", code->size, data->size);
+    for (i = 0; i < total; i++) {
+        word = wordAt(code, data, i);
+        digits[0] = hexDigits[(word >> 8) & 0xF];
+        digits[1] = hexDigits[(word >> 4) & 0xF];
+        digits[2] = hexDigits[word & 0xF];
+        fprintf(outputFile, "%04d ", START_ADDRESS + i);
+        fwrite(digits, 1, sizeof(digits), outputFile);
+    }
+}
+/******************************************************************************/
+/**
+ * Writes each word as a 16-bit little-endian integer.
+ */
+void encodeRaw(const WordImage *code, const WordImage *data, FILE *outputFile) {
+    int i, total = code->size + data->size;
+    unsigned int word;
+
+    for (i = 0; i < total; i++) {
+        word = wordAt(code, data, i);
+        fputc((int) (word & 0xFF), outputFile);
+        fputc((int) (word >> 8), outputFile);
+    }
+}
+/******************************************************************************/
+/**
+ * Writes an Intel HEX record: its byte count, address and type, its bytes in
+ * hex, and the two's complement of the sum of all of them.
+ *
+ * @param type - The record type.
+ * @param address - The lower 16 bits of the address of the first byte.
+ * @param bytes - The bytes of the record.
+ * @param count - The number of bytes.
+ * @param outputFile - The output file.
+ */
+void writeIntelHexRecord(int type, unsigned long address,
+                         const unsigned char *bytes, int count,
+                         FILE *outputFile) {
+    unsigned int checksum = count + ((address >> 8) & 0xFF) +
+                            (address & 0xFF) + type;
+    int i;
+
+    fprintf(outputFile, ":%02X%04lX%02X", count, address & 0xFFFF, type);
+    for (i = 0; i < count; i++) {
+        fputc(hexDigits[bytes[i] >> 4], outputFile);
+        fputc(hexDigits[bytes[i] & 0xF], outputFile);
+        checksum += bytes[i];
+    }
+    fprintf(outputFile, "%02X\n", (-checksum) & 0xFF);
+}
+/******************************************************************************/
+/**
+ * Writes the words as Intel HEX data records of IHEX_RECORD_BYTES bytes, each
+ * word as a 16-bit little-endian integer at twice its address. An extended
+ * linear address record precedes the records above 64K, and an end of file
+ * record ends the file.
+ */
+void encodeIntelHex(const WordImage *code, const WordImage *data,
+                    FILE *outputFile) {
+    unsigned char bytes[IHEX_RECORD_BYTES], segment[2];
+    unsigned long address = 2UL * START_ADDRESS, recordAddress = address;
+    unsigned long upperAddress = 0;
+    int i, count = 0, total = code->size + data->size;
+    unsigned int word;
+
+    for (i = 0; i < total; i++) {
+        if (count == 0) {
+            recordAddress = address;
+            if ((recordAddress >> 16) != upperAddress) {
+                upperAddress = recordAddress >> 16;
+                segment[0] = (unsigned char) (upperAddress >> 8);
+                segment[1] = (unsigned char) (upperAddress & 0xFF);
+                writeIntelHexRecord(4, 0, segment, 2, outputFile);
+            }
+        }
+        word = wordAt(code, data, i);
+        bytes[count++] = (unsigned char) (word & 0xFF);
+        bytes[count++] = (unsigned char) (word >> 8);
+        address += 2;
+        /* A record doesn't cross a 64K boundary */
+        if (count == IHEX_RECORD_BYTES || (address & 0xFFFF) == 0) {
+            writeIntelHexRecord(0, recordAddress, bytes, count, outputFile);
+            count = 0;
+        }
+    }
+    if (count > 0) {
+        writeIntelHexRecord(0, recordAddress, bytes, count, outputFile);
+    }
+    writeIntelHexRecord(1, 0, NULL, 0, outputFile);
+}
+/******************************************************************************/
+/**
+ * Returns the index of the output format with the given name.
+ *
+ * @param name - The name of the format, as given to --format.
+ * @return The index of the format, or -1 if there is no such format.
+ */
+int findOutputEncoder(const char *name) {
+    int i;
+    for (i = 0; i < outputEncodersSize; i++) {
+        if (strcmp(outputEncoders[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+/******************************************************************************/
+/**
+ * Returns the number of output formats.
+ */
+int numOfOutputEncoders(void) {
+    return outputEncodersSize;
+}
+/******************************************************************************/
+/**
+ * Returns the output format of the given index.
+ *
+ * @param index - The index of the format, as returned by findOutputEncoder.
+ */
+const OutputEncoder *getOutputEncoder(int index) {
+    return &outputEncoders[index];
+}
+/******************************************************************************/
+/**
+ * Writes the instruction words followed by the data words of a program to the
+ * output file of a format.
+ *
+ * @param encoder - The output format.
+ * @param output_file - The path of the output file, the name of the processed
+ *                      file with the extension of the format.
+ * @param code - The instruction words of the program.
+ * @param data - The data words of the program.
+ */
+void writeEncodedOutput(const OutputEncoder *encoder, const char *output_file,
+                        const WordImage *code, const WordImage *data) {
+    FILE *outputFile = NULL;
+
+    outputFile = fopen(output_file, encoder->mode);
+    if (NULL == outputFile) {
+        printf("Failed to open the file.\n");
+        exit(1);
+    }
+    encoder->encode(code, data, outputFile);
+    STATS_ADD(STAT_BYTES_WRITTEN, ftell(outputFile));
+
+    fclose(outputFile);
+}
+/******************************************************************************/
@@ -0,0 +1,72 @@
+/*********************************FILE__HEADER*********************************\
+* File:					output_encoders.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			This header file provides the output encoders, which
+*                       write the in-memory code and data images of a program
+*                       in one of the supported output formats. Any number of
+*                       formats may be written from the same images, so a
+*                       program is assembled once for all of them.
+\******************************************************************************/
+
+#ifndef MAMAN14_OUTPUT_ENCODERS_H
+#define MAMAN14_OUTPUT_ENCODERS_H
+
+#include <stdio.h>
+
+#include "word_image.h"
+
+/* The longest extension of an output file, without the '\0' */
+#define MAX_OUTPUT_EXTENSION_LENGTH 4
+
+/* The number of Intel HEX data bytes in each record */
+#define IHEX_RECORD_BYTES 16
+
+/**************************** Structs  Definitions ****************************/
+/* Writes the instruction words followed by the data words to an open file */
+typedef void (*EncodeImage)(const WordImage *code, const WordImage *data,
+                            FILE *outputFile);
+
+/* An output format */
+typedef struct {
+    const char *name; /* The name of the format in the --format option */
+    const char *extension; /* The extension of its output file */
+    const char *mode; /* The fopen mode of its output file */
+    EncodeImage encode;
+} OutputEncoder;
+
+/******************************************************************************/
+/**
+ * Returns the index of the output format with the given name.
+ *
+ * @param name - The name of the format, as given to --format.
+ * @return The index of the format, or -1 if there is no such format.
+ */
+int findOutputEncoder(const char *name);
+
+/**
+ * Returns the number of output formats.
+ */
+int numOfOutputEncoders(void);
+
+/**
+ * Returns the output format of the given index.
+ *
+ * @param index - The index of the format, as returned by findOutputEncoder.
+ */
+const OutputEncoder *getOutputEncoder(int index);
+
+/**
+ * Writes the instruction words followed by the data words of a program to the
+ * output file of a format.
+ *
+ * @param encoder - The output format.
+ * @param output_file - The path of the output file, the name of the processed
+ *                      file with the extension of the format.
+ * @param code - The instruction words of the program.
+ * @param data - The data words of the program.
+ */
+void writeEncodedOutput(const OutputEncoder *encoder, const char *output_file,
+                        const WordImage *code, const WordImage *data);
+
+#endif
@@ -17,6 +17,7 @@
 #include <ctype.h>
 
 #include "param_validation.h"
+#include "stats.h"
 
 /************************* Functions  Implementations *************************/
 /**
@@ -38,6 +39,27 @@ int isNumber(const char *str) {
     return 1;
 }
 
+/******************************************************************************/
+/**
+ * Returns the number of the given register operand.
+ * A register operand is the name of a register preceded by '@'.
+ *
+ * @param str - The operand to find.
+ * @return The number of the register if found, and -1 otherwise.
+ */
+int findRegister(const char *str) {
+    int i;
+    if (str != NULL && str[0] == '@') {
+        for (i = 0; i < registersListSize; i++) {
+            STATS_COUNT(STAT_STRING_COMPARISONS);
+            if (strcmp(str + 1, registersList[i]) == 0) {
+                return registerNumbers[i];
+            }
+        }
+    }
+    return -1;
+}
+
 /******************************************************************************/
 /**
  * Checks if the given string is a valid register.
@@ -47,19 +69,7 @@ int isNumber(const char *str) {
  * @return 1 if the string is a register, and 0 otherwise.
  */
 int isRegister(const char *str) {
-    const char *operand = NULL;
-    int i;
-    if (str != NULL) {
-        if (str[0] == '@') {
-            operand = str + 1;
-            for (i = 0; i < registersListSize; i++) {
-                if (strcmp(operand, registersList[i]) == 0) {
-                    return 1;
-                }
-            }
-        }
-    }
-    return 0;
+    return findRegister(str) != -1;
 }
 
 /******************************************************************************/
@@ -71,16 +81,49 @@ int isRegister(const char *str) {
  * @return 1 if the label exists in the program state, and 0 otherwise.
  */
 int isLabel(const char *str, ProgramState *programState) {
+    return getLabelIndex(str, programState) != -1;
+}
+
+/******************************************************************************/
+/**
+ * Checks if the given string may name a label: it starts with a letter, has
+ * only letters and digits, fits in MAX_LABEL_LENGTH and isn't a command name.
+ * Used for references to labels that are not defined yet.
+ *
+ * @param str - The string to check.
+ * @return 1 if the string may name a label, and 0 otherwise.
+ */
+int isLabelName(const char *str) {
+    char lowercase[MAX_LABEL_LENGTH];
     int i;
-    Label *labelPtr;
 
-    for (i = 0; i < programState->labels->size; i++) {
-        labelPtr = (Label *) programState->labels->items[i];
-        if (strcmp(str, labelPtr->name) == 0) {
-            return 1;
+    if (!isalpha((unsigned char) str[0])) {
+        return 0;
+    }
+    for (i = 0; str[i] != '\0'; i++) {
+        if (i >= MAX_LABEL_LENGTH - 1 || !isalnum((unsigned char) str[i])) {
+            return 0;
         }
+        lowercase[i] = (char) tolower((unsigned char) str[i]);
     }
-    return 0;
+    lowercase[i] = '\0';
+
+    return lookupCommand(lowercase) == -1;
+}
+
+/******************************************************************************/
+/**
+ * Checks if the given string is a label operand. A label operand is a label
+ * of the program state, or in one-pass mode, where labels are added as their
+ * definitions are reached, any name that may be a label defined later.
+ *
+ * @param str - The operand to check.
+ * @param programState - The current program state.
+ * @return 1 if the string is a label operand, and 0 otherwise.
+ */
+int isLabelOperand(const char *str, ProgramState *programState) {
+    return isLabel(str, programState) ||
+           (programState->onePass && isLabelName(str));
 }
 
 /******************************************************************************/
@@ -93,11 +136,16 @@ int isLabel(const char *str, ProgramState *programState) {
  *         and FALSE otherwise.
  */
 Boolean isLabelExists(char *label, ProgramState *programState) {
+    unsigned long hash = name_hash(label, strlen(label));
+    int slot = name_index_start(&programState->labelIndex, hash);
     int i;
     Label *labelPtr;
 
-    for (i = 0; i < programState->labels->size; i++) {
-        labelPtr = (Label *) programState->labels->items[i];
+    STATS_COUNT(STAT_SYMBOL_LOOKUPS);
+    while ((i = name_index_next(&programState->labelIndex, hash,
+                                &slot)) != -1) {
+        labelPtr = &programState->labels.items[i];
+        STATS_COUNT(STAT_STRING_COMPARISONS);
         if (strcmp(label, labelPtr->name) == 0) {
             if (!labelPtr->isExtern) {
                 return TRUE;
@@ -110,22 +158,28 @@ Boolean isLabelExists(char *label, ProgramState *programState) {
 /******************************************************************************/
 /**
  * Returns the index of the given label in the program state's labels list.
+ * The label is found by the label index of the program state. When several
+ * labels have the name, the first one added is returned.
  *
  * @param str - The label to find.
  * @param programState - The current program state.
  * @return The index of the label if found, and -1 otherwise.
  */
 int getLabelIndex(const char *str, ProgramState *programState) {
-    int i;
-    Label *labelPtr;
+    unsigned long hash = name_hash(str, strlen(str));
+    int slot = name_index_start(&programState->labelIndex, hash);
+    int i, first = -1;
 
-    for (i = 0; i < programState->labels->size; i++) {
-        labelPtr = (Label *) programState->labels->items[i];
-        if (strcmp(str, labelPtr->name) == 0) {
-            return i;
+    STATS_COUNT(STAT_SYMBOL_LOOKUPS);
+    while ((i = name_index_next(&programState->labelIndex, hash,
+                                &slot)) != -1) {
+        STATS_COUNT(STAT_STRING_COMPARISONS);
+        if ((first == -1 || i < first) &&
+            strcmp(str, programState->labels.items[i].name) == 0) {
+            first = i;
         }
     }
-    return -1;
+    return first;
 }
 
 /******************************************************************************/
@@ -146,6 +200,7 @@ int findInstruction(const char *instruction) {
 
     for (instructionIdx = 0;
          instructionIdx < instructionsListSize; instructionIdx++) {
+        STATS_COUNT(STAT_STRING_COMPARISONS);
         if (strcmp(comparisonInstruction, instructionsList[instructionIdx]) ==
             0) {
             return instructionIdx;
@@ -154,6 +209,32 @@ int findInstruction(const char *instruction) {
     return -1;
 }
 
+/******************************************************************************/
+/**
+ * Returns the index of the given lowercase mnemonic in the commands list.
+ * The mnemonic is found in the collision-free hash table generated by isa_gen,
+ * so at most a single mnemonic is compared.
+ *
+ * @param mnemonic - The mnemonic to find.
+ * @return The index of the command if found, and -1 otherwise.
+ */
+int lookupCommand(const char *mnemonic) {
+    unsigned long hash = 0;
+    const char *c;
+    int idx;
+
+    /* The hash of isa_gen, see isa_tables.h */
+    for (c = mnemonic; *c; c++) {
+        hash = hash * ISA_COMMAND_HASH_MULTIPLIER + (unsigned char) *c;
+    }
+    idx = commandHash[hash & (ISA_COMMAND_HASH_SIZE - 1)];
+    STATS_ADD(STAT_STRING_COMPARISONS, idx != -1);
+    if (idx != -1 && strcmp(commandsList[idx], mnemonic) == 0) {
+        return idx;
+    }
+    return -1;
+}
+
 /******************************************************************************/
 /**
  * Returns the index of the given command in the commands list.
@@ -163,15 +244,9 @@ int findInstruction(const char *instruction) {
  * @return The index of the command if found, and -1 otherwise.
  */
 int findCommand(char *command) {
-    int i;
     /* Convert command to lowercase */
     to_lowercase(command);
-    for (i = 0; i < commandsListSize; i++) {
-        if (strcmp(commandsList[i], command) == 0) {
-            return i;
-        }
-    }
-    return -1;
+    return lookupCommand(command);
 }
 
 /******************************************************************************/
@@ -190,16 +265,17 @@ int isValidParam(char *param, OperandType expectedType,
         case OPERAND_TYPE_NONE:
             return 0;
         case OPERAND_TYPE_LABEL:
-            return isLabel(param, currentProgramState);
+            return isLabelOperand(param, currentProgramState);
         case OPERAND_TYPE_REGISTER:
             return isRegister(param);
         case OPERAND_TYPE_NUMBER:
             return isNumber(param);
         case OPERAND_TYPE_LABEL_OR_REGISTER:
-            return isLabel(param, currentProgramState) || isRegister(param);
+            return isLabelOperand(param, currentProgramState) ||
+                   isRegister(param);
         case OPERAND_TYPE_ALL:
-            return isLabel(param, currentProgramState) || isRegister(param) ||
-                   isNumber(param);
+            return isLabelOperand(param, currentProgramState) ||
+                   isRegister(param) || isNumber(param);
         default:
             return 0;
     }
@@ -218,7 +294,7 @@ int findParameterType(char *operand, ProgramState *programState) {
     if (isNumber(operand)) {
 
         return NUMBER;
-    } else if (isLabel(operand, currentProgramState)) {
+    } else if (isLabelOperand(operand, currentProgramState)) {
         return LABEL;
     } else if (isRegister(operand)) {
         return REGISTER;
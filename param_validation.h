@@ -20,6 +20,13 @@
 /* Function that checks if a given string is a label in the program state */
 int isLabel(const char *str, ProgramState *programState);
 
+/* Function that checks if a given string may name a label that isn't defined yet */
+int isLabelName(const char *str);
+
+/* Function that checks if a given string is a label operand: a label of the
+ * program state or, in one-pass mode, a label that may be defined later */
+int isLabelOperand(const char *str, ProgramState *programState);
+
 /* Function that returns the index of a given label in the program state */
 int getLabelIndex(const char *str, ProgramState *programState);
 
@@ -32,9 +39,15 @@ int isNumber(const char *str);
 /* Function that checks if a given string is a register */
 int isRegister(const char *str);
 
+/* Function that finds the number of a given register operand */
+int findRegister(const char *str);
+
 /* Function that finds the index of a given instruction in the instruction list */
 int findInstruction(const char *instruction);
 
+/* Function that finds the index of a given lowercase mnemonic in the commands list */
+int lookupCommand(const char *mnemonic);
+
 /* Function that finds the index of a given command in the commands list */
 int findCommand(char *command);
 
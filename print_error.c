@@ -58,7 +58,68 @@ static const char *CommaErrorMessages[] = {
         "Extra comma at the end of the line"
 };
 
+/**
+ * The included file and line the errors currently come from.
+ * originFile is NULL while processing lines of the processed file itself.
+ */
+static const char *originFile = NULL;
+static int originLine = 0;
+
+/* The number of errors printed so far in the run */
+static long numOfErrors = 0;
+
+/* The errors of the run when the current file started, and its error limit */
+static long fileErrorsStart = 0;
+static long maxFileErrors = 0;
+
 /************************* Functions  Implementations *************************/
+/**
+ * Sets the origin of the next error messages.
+ *
+ * @param fileName - The included file the current line came from, or NULL.
+ * @param lineNumber - The line number in that file.
+ */
+void SetErrorOrigin(const char *fileName, int lineNumber) {
+    originFile = fileName;
+    originLine = lineNumber;
+}
+/******************************************************************************/
+/**
+ * Returns the number of errors printed so far in the run.
+ *
+ * @return The number of errors.
+ */
+long GetNumOfErrors(void) {
+    return numOfErrors;
+}
+/******************************************************************************/
+/**
+ * Counts an error printed by another module among the errors of the run.
+ */
+void CountError(void) {
+    numOfErrors++;
+}
+/******************************************************************************/
+/**
+ * Starts counting the errors of a file.
+ *
+ * @param maxErrors - The number of errors the file is processed until, or 0
+ *                    for no limit.
+ */
+void StartFileErrors(long maxErrors) {
+    fileErrorsStart = numOfErrors;
+    maxFileErrors = maxErrors;
+}
+/******************************************************************************/
+/**
+ * Checks whether the current file has reached its error limit.
+ *
+ * @return 1 if the file has as many errors as its limit, 0 otherwise.
+ */
+int ErrorLimitReached(void) {
+    return maxFileErrors > 0 && numOfErrors - fileErrorsStart >= maxFileErrors;
+}
+/******************************************************************************/
 /**
  * Prints an error message to stdout.
  *
@@ -66,9 +127,16 @@ static const char *CommaErrorMessages[] = {
  * @param errorMessage - A string containing the error message.
  *
  * The function takes a line number and an error message as inputs and prints them to stdout.
+ * If the line came from an included file, its file and line are printed as well.
  */
 void printErrorMessage(int lineNumber, char *errorMessage) {
-    fprintf(stdout, "Error on line %d: %s\n", lineNumber, errorMessage);
+    numOfErrors++;
+    if (originFile != NULL) {
+        fprintf(stdout, "Error on line %d (%s:%d): %s\n", lineNumber,
+                originFile, originLine, errorMessage);
+    } else {
+        fprintf(stdout, "Error on line %d: %s\n", lineNumber, errorMessage);
+    }
 }
 /******************************************************************************/
 /**
@@ -99,7 +167,7 @@ void PrintCommaErrorMessage(int lineNumber, CommaErrorType errorMessageId,
  * and then calls printErrorMessage to print the formatted message.
  */
 void PrintLabelErrorMessage(int lineNumber, LabelErrorType errorMessageId,
-                            char *labelName) {
+                            const char *labelName) {
     char errorMessage[256];
     if (labelName != NULL) {
         sprintf(errorMessage, LabelErrorMessages[errorMessageId], labelName);
@@ -50,6 +50,35 @@ typedef enum {
     EXTRA_COMMA_END_OF_LINE
 } CommaErrorType;
 
+/**
+ * Function to set the included file and line the next errors come from.
+ * A NULL file name means the errors come from the processed file itself.
+ */
+void SetErrorOrigin(const char *fileName, int lineNumber);
+
+/**
+ * Function to get the number of errors printed so far in the run.
+ */
+long GetNumOfErrors(void);
+
+/**
+ * Function to count an error printed by another module, such as the
+ * preprocessor, among the errors of the run.
+ */
+void CountError(void);
+
+/**
+ * Function to start counting the errors of a file, which is processed until
+ * it has the given number of errors (--max-errors). 0 means no limit.
+ */
+void StartFileErrors(long maxErrors);
+
+/**
+ * Function to check whether the current file has reached its error limit,
+ * so that its processing stops.
+ */
+int ErrorLimitReached(void);
+
 /**
  * Function to print an error message based on a given CommaErrorType.
  */
@@ -60,7 +89,7 @@ void PrintCommaErrorMessage(int lineNumber, CommaErrorType errorMessageId,
  * Function to print an error message based on a given LabelErrorType.
  */
 void PrintLabelErrorMessage(int lineNumber, LabelErrorType errorMessageId,
-                            char *labelName);
+                            const char *labelName);
 
 /**
  * Function to print an error message based on a given CommandInstructionErrorType.
@@ -10,6 +10,11 @@
 #define MAMAN14_PROGRAM_CONSTANTS_H
 
 #include "vector.h"
+#include "macro.h"
+#include "word_image.h"
+#include "typed_vector.h"
+#include "line_tokenizer.h"
+#include "name_index.h"
 
 /* Maximum length and number of lines and labels */
 #define MAX_LINE_LENGTH 80
@@ -41,93 +46,96 @@ typedef enum {
     EXTERN_INSTRUCTION
 } Instruction;
 
+/* The commands, registers and word layouts, generated from the ISA
+ * description (isa.def) by isa_gen */
+#include "isa_tables.h"
+
+/* Addressing modes, as encoded in the command word */
 typedef enum {
-    NUMBER = 1,
-    LABEL = 3,
-    REGISTER = 5
+    NUMBER = ISA_MODE_NUMBER,
+    LABEL = ISA_MODE_LABEL,
+    REGISTER = ISA_MODE_REGISTER
 } Types;
 
 /**************************** Structs  Definitions ****************************/
-/* Struct to hold each line in the source code */
-typedef struct Line {
-    char **input_words;
-    struct Line *next;
-    int line_number;
-    int num_of_words;
-    int has_label;
-} Line;
+/* The kinds of statements */
+typedef enum {
+    STATEMENT_NONE, /* A line without words, or with errors */
+    STATEMENT_COMMAND,
+    STATEMENT_DATA,
+    STATEMENT_STRING,
+    STATEMENT_ENTRY /* An '.entry' directive checked by ResolveFixups, in one pass */
+} StatementKind;
+
+/* The shapes of the operands of a command, each encoded by its own emitter */
+typedef enum {
+    COMMAND_SHAPE_NO_OPERANDS, /* Only the command word */
+    COMMAND_SHAPE_ONE_OPERAND, /* The word of the target operand */
+    COMMAND_SHAPE_REGISTER_PAIR, /* Two register operands sharing a word */
+    COMMAND_SHAPE_TWO_OPERANDS /* A word for each of the two operands */
+} CommandShape;
+
+/* An operand of a command, decoded by its addressing mode */
+typedef struct {
+    union {
+        int number; /* The value of an immediate number */
+        int reg; /* The number of a register */
+        const char *symbol; /* The name of a label */
+    } value;
+    signed char mode; /* NUMBER, LABEL, REGISTER or OPERAND_TYPE_NONE */
+} StatementOperand;
+
+/* A line of the .am file, decoded once and then sized and encoded.
+ * The operands of a '.data' or '.string' directive are read from its
+ * tokenized line when it is encoded */
+typedef struct {
+    const TokenizedLine *source; /* The tokenized line of the statement */
+    StatementOperand operands[2]; /* The source and target operands of a command, or the label of an '.entry' */
+    int line_number; /* The line number in the .am file */
+    int num_of_words; /* The number of words the statement is encoded with */
+    signed char kind; /* A StatementKind */
+    signed char opcode; /* The index of the command, or of the directive */
+    signed char shape; /* The CommandShape of a command */
+} Statement;
+
+/* A vector of Statements, in the order of the lines */
+DECLARE_TYPED_VECTOR(StatementVector, Statement, statement_vector)
 
 /* Struct to hold labels and their attributes */
 typedef struct {
     char name[MAX_LABEL_LENGTH];
     int line_number;
     int asm_line_number;
+    int isData; /* Defined by a data line, its address is rebased past the code */
     int isExtern;
     int isEntry;
 } Label;
 
+/* A vector of Labels, stored next to each other */
+DECLARE_TYPED_VECTOR(LabelVector, Label, label_vector)
+
 /* Struct defining the program's state. */
 typedef struct {
-    Vector *labels; /* Pointer to the dynamically allocated array of labels used in the program. */
-    Vector *externalLabels;/* Pointer to the dynamically allocated array of external labels used in the program. */
-    int current_line_number; /* Current line number being processed. */
+    LabelVector labels; /* The labels defined or declared extern in the program. */
+    NameIndex labelIndex; /* The indices of the labels, by their names. */
+    LabelVector externalLabels; /* A copy of an extern label for each word referring to it, allocated from the arena. */
+    Vector *amLines; /* The tokenized lines of the .am file, in order. Macro call sites share the macro's lines. */
+    StatementVector statements; /* The decoded statement of each of the .am lines, in order. */
+    Arena *arena; /* Owns the tokenized lines, external labels and fixups of the file, reset for every file. */
+    MacroVector *macros; /* The macros defined in the program, owning their tokenized bodies. */
+    Vector *includeCache; /* The files included in the run, shared by all the processed files. */
+    WordImage *code; /* The instruction words of the program, loaded from START_ADDRESS. */
+    WordImage *data; /* The data words of the program, loaded right after the instruction words. */
+    Vector *fixups; /* The label references to patch into the image once all the labels are known. */
+    int onePass; /* Whether labels are defined while the lines are encoded, without a separate label pass. */
     int IC; /* Instruction Counter - total number of instruction words in the program. */
     int DC; /* Data Counter - total number of data words in the program. */
 } ProgramState;
 
 /******************* Global variable definitions ******************************/
-/* Lists of supported commands, instructions, and registers */
-static const char *commandsList[] = {"mov", "cmp", "add", "sub", "not", "clr",
-                                     "lea", "inc", "dec", "jmp", "bne", "red",
-                                     "prn", "jsr", "rts", "stop"};
-static const int commandsListSize = sizeof(commandsList) / sizeof(char *);
-
+/* Lists of supported instructions */
 static const char *instructionsList[] = {"data", "string", "entry", "extern"};
 static const int instructionsListSize =
         sizeof(instructionsList) / sizeof(char *);
 
-static const char *registersList[] = {"r1", "r2", "r3", "r4", "r5", "r6", "r7"};
-static const int registersListSize = sizeof(registersList) / sizeof(char *);
-
-/* Specification of the operand types for each command */
-static const OperandType operandTypes[][2] = {
-        {OPERAND_TYPE_ALL,   OPERAND_TYPE_LABEL_OR_REGISTER}, /* mov */
-        {OPERAND_TYPE_ALL,   OPERAND_TYPE_ALL},               /* cmp */
-        {OPERAND_TYPE_ALL,   OPERAND_TYPE_LABEL_OR_REGISTER}, /* add */
-        {OPERAND_TYPE_ALL,   OPERAND_TYPE_LABEL_OR_REGISTER}, /* sub */
-        {OPERAND_TYPE_NONE,  OPERAND_TYPE_LABEL_OR_REGISTER}, /* not */
-        {OPERAND_TYPE_NONE,  OPERAND_TYPE_LABEL_OR_REGISTER}, /* clr */
-        {OPERAND_TYPE_LABEL, OPERAND_TYPE_LABEL_OR_REGISTER}, /* lea */
-        {OPERAND_TYPE_NONE,  OPERAND_TYPE_LABEL_OR_REGISTER}, /* inc */
-        {OPERAND_TYPE_NONE,  OPERAND_TYPE_LABEL_OR_REGISTER}, /* dec */
-        {OPERAND_TYPE_NONE,  OPERAND_TYPE_LABEL_OR_REGISTER}, /* jmp */
-        {OPERAND_TYPE_NONE,  OPERAND_TYPE_LABEL_OR_REGISTER}, /* bne */
-        {OPERAND_TYPE_NONE,  OPERAND_TYPE_LABEL_OR_REGISTER}, /* red */
-        {OPERAND_TYPE_NONE,  OPERAND_TYPE_ALL},  /* prn */
-        {OPERAND_TYPE_NONE,  OPERAND_TYPE_LABEL_OR_REGISTER}, /* jsr */
-        {OPERAND_TYPE_NONE,  OPERAND_TYPE_NONE}, /* rts */
-        {OPERAND_TYPE_NONE,  OPERAND_TYPE_NONE}  /* stop */
-};
-
-/* Specification of the number of parameters for each command */
-static const int paramCount[] = {
-        2,  /* mov */
-        2,  /* cmp */
-        2,  /* add */
-        2,  /* sub */
-        1,  /* not */
-        1,  /* clr */
-        2,  /* lea */
-        1,  /* inc */
-        1,  /* dec */
-        1,  /* jmp */
-        1,  /* bne */
-        1,  /* red */
-        1,  /* prn */
-        1,  /* jsr */
-        0,  /* rts */
-        0   /* stop */
-};
-
-
 #endif
\ No newline at end of file
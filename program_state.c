@@ -0,0 +1,115 @@
+/*********************************FILE__HEADER*********************************\
+* File:                 program_state.c
+* Authors:              Daniel Brodsky & Lior Katav
+* Date:                 August-2023
+* Description:          The life cycle of the ProgramState: it is allocated
+*                       once, reset before each file, keeping the memory of
+*                       its vectors, word images, macros and arena, and freed
+*                       after the last file.
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <stdlib.h>
+
+#include "program_state.h"
+#include "macro.h"
+#include "vector.h"
+#include "word_image.h"
+#include "arena.h"
+
+/************************* Functions  Implementations *************************/
+/**
+ * Initializes a ProgramState structure by allocating memory for the
+ * labels, externalLabels, .am lines and macros vectors and the arena, and
+ * setting initial values for all members.
+ *
+ * @param programState - A pointer to the ProgramState structure to initialize.
+ */
+void initProgramState(ProgramState *programState) {
+    programState->arena = new_arena();
+    label_vector_init(&programState->labels, NULL);
+    name_index_init(&programState->labelIndex);
+    label_vector_init(&programState->externalLabels, programState->arena);
+    programState->amLines = new_vector();
+    statement_vector_init(&programState->statements, NULL);
+    programState->macros = new_macro_vector();
+    programState->includeCache = NULL;
+    programState->code = new_word_image();
+    programState->data = new_word_image();
+    programState->fixups = new_vector();
+    programState->onePass = 0;
+    programState->IC = 0;
+    programState->DC = 0;
+}
+/******************************************************************************/
+/**
+ * Empties a ProgramState for the next file, keeping the memory of its
+ * vectors, word images, macros and arena, so they are only grown by a file
+ * larger than all the previous ones.
+ *
+ * @param programState - A pointer to the ProgramState structure to reset.
+ */
+void resetProgramState(ProgramState *programState) {
+    label_vector_clear(&programState->labels);
+    name_index_clear(&programState->labelIndex);
+    reset_vector(programState->amLines);
+    statement_vector_clear(&programState->statements);
+    reset_vector(programState->fixups);
+    reset_macro_vector(programState->macros);
+    reset_word_image(programState->code);
+    reset_word_image(programState->data);
+    reset_arena(programState->arena);
+    /* The external labels were released with the arena */
+    label_vector_init(&programState->externalLabels, programState->arena);
+    programState->IC = 0;
+    programState->DC = 0;
+}
+/******************************************************************************/
+/**
+ * Frees up allocated memory for labels, external labels, .am lines and macros,
+ * to prevent memory leaks and manage memory of dynamic memory allocated arrays
+ * in the program.
+ *
+ * @param programState - Pointer to the ProgramState object to be freed.
+ */
+void freeProgramState(ProgramState *programState) {
+    label_vector_free(&programState->labels);
+    name_index_free(&programState->labelIndex);
+    /* The external labels and the fixups are owned by the arena */
+    label_vector_free(&programState->externalLabels);
+
+    /* The .am lines only refer to lines owned by the arenas */
+    if (programState->amLines != NULL) {
+        free_vector_shallow(programState->amLines);
+        programState->amLines = NULL;
+    }
+
+    statement_vector_free(&programState->statements);
+
+
+    if (programState->macros != NULL) {
+        free_macro_vector(programState->macros);
+        programState->macros = NULL;
+    }
+
+    if (programState->code != NULL) {
+        free_word_image(programState->code);
+        programState->code = NULL;
+    }
+
+    if (programState->data != NULL) {
+        free_word_image(programState->data);
+        programState->data = NULL;
+    }
+
+    if (programState->fixups != NULL) {
+        free_vector_shallow(programState->fixups);
+        programState->fixups = NULL;
+    }
+
+    if (programState->arena != NULL) {
+        free_arena(programState->arena);
+        programState->arena = NULL;
+    }
+}
+/******************************************************************************/
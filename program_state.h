@@ -0,0 +1,37 @@
+/*********************************FILE__HEADER*********************************\
+* File:					program_state.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			API of the life cycle of the ProgramState, shared by
+*                       the assembler and the fuzzing target, so that both
+*                       reset it between files the same way.
+\******************************************************************************/
+
+#ifndef MAMAN14_PROGRAM_STATE_H
+#define MAMAN14_PROGRAM_STATE_H
+
+#include "program_constants.h"
+
+/**
+ * Initializes a ProgramState structure, allocating its vectors, word images,
+ * macros and arena.
+ *
+ * @param programState - A pointer to the ProgramState structure to initialize.
+ */
+void initProgramState(ProgramState *programState);
+
+/**
+ * Empties a ProgramState for the next file, keeping its memory.
+ *
+ * @param programState - A pointer to the ProgramState structure to reset.
+ */
+void resetProgramState(ProgramState *programState);
+
+/**
+ * Frees the memory of a ProgramState.
+ *
+ * @param programState - Pointer to the ProgramState object to be freed.
+ */
+void freeProgramState(ProgramState *programState);
+
+#endif
@@ -0,0 +1,335 @@
+/*********************************FILE__HEADER*********************************\
+* File:					stats.c
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			Implementation of the run statistics. The text report
+*                       is written to stderr, apart from the messages of the
+*                       assembler. The JSON report is kept in memory and
+*                       written at the end of the run, in one piece, to a
+*                       file of its own, which no message is written to. The
+*                       file is only created then, so a run that stops early
+*                       leaves no partial report behind.
+*                       The wall time is read from the POSIX
+*                       monotonic clock where there is one, and from time()
+*                       otherwise, and the CPU time from clock().
+\******************************************************************************/
+
+/* For clock_gettime, the rest of the file is C89 */
+#define _POSIX_C_SOURCE 199309L
+
+/******************************** Header Files ********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "stats.h"
+#include "hw_counters.h"
+#include "trace.h"
+#include "print_error.h" /* for GetNumOfErrors */
+#include "utils.h" /* for fprint_json_string and my_malloc */
+
+/**************************** Structs  Definitions ****************************/
+/* The statistics of a file, or the total of the files */
+typedef struct {
+    double wallSeconds[NUM_OF_STATS_STAGES];
+    double cpuSeconds[NUM_OF_STATS_STAGES];
+    long counters[NUM_OF_STATS];
+    char *name; /* The name of the file, kept for the JSON report */
+} FileStats;
+
+/******************* Global variable definitions ******************************/
+long statsCounters[NUM_OF_STATS];
+
+static const char *statsStageNames[NUM_OF_STATS_STAGES] = {
+        "preProcess", "checkLabels", "ParseFile", "WriteLabelsToFile",
+        "output"
+};
+
+static const char *statsCounterNames[NUM_OF_STATS] = {
+        "bytes_read", "bytes_written", "macros_defined", "macros_expanded",
+        "symbol_lookups", "string_comparisons", "lines", "labels", "IC", "DC"
+};
+
+static StatsFormat statsFormat = STATS_OFF;
+static FileStats currentFile, totalFiles;
+static int numOfFiles = 0;
+
+/* The JSON report: its file, and the statistics of the files reported so far */
+static const char *statsJsonFile = NULL;
+static FileStats *reportedFiles = NULL;
+static int reportedFilesCapacity = 0;
+
+/* When the file and the stage being timed started, and the errors reported
+ * before the stage */
+static double fileWallStart = 0, stageWallStart = 0, stageCpuStart = 0;
+static long stageErrorsStart = 0;
+
+/************************* Functions  Implementations *************************/
+/**
+ * Returns the wall time, in seconds from an arbitrary point.
+ */
+double stats_wall_seconds(void) {
+#ifdef CLOCK_MONOTONIC
+    struct timespec now;
+    if (clock_gettime(CLOCK_MONOTONIC, &now) == 0) {
+        return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+    }
+#endif
+    return (double) time(NULL);
+}
+/******************************************************************************/
+/**
+ * Returns the CPU time of the process, in seconds.
+ */
+double cpuSeconds(void) {
+    return (double) clock() / CLOCKS_PER_SEC;
+}
+/******************************************************************************/
+/**
+ * Enables the statistics, reported in the given format.
+ *
+ * @param format - The format of the report, or STATS_OFF.
+ * @param json_file - The file of the JSON report, created by stats_end_run,
+ *                    or NULL for another format.
+ */
+void stats_enable(StatsFormat format, const char *json_file) {
+    statsFormat = format;
+    statsJsonFile = json_file;
+}
+/******************************************************************************/
+/**
+ * Starts the statistics of a file, clearing the counters.
+ */
+void stats_begin_file(void) {
+    memset(statsCounters, 0, sizeof(statsCounters));
+    memset(&currentFile, 0, sizeof(currentFile));
+    fileWallStart = stats_wall_seconds();
+}
+/******************************************************************************/
+/**
+ * Starts timing a stage of the file.
+ *
+ * @param stage - The stage.
+ */
+void stats_start_stage(StatsStage stage) {
+    if (statsFormat != STATS_OFF || traceEnabled) {
+        stageWallStart = stats_wall_seconds();
+        stageCpuStart = cpuSeconds();
+        stageErrorsStart = GetNumOfErrors();
+    }
+    /* Started last and stopped first, so they count only the stage */
+    hw_counters_start_stage(stage);
+}
+/******************************************************************************/
+/**
+ * Stops timing a stage of the file, adding its time to the file, and traces
+ * it along with the errors it reported.
+ *
+ * @param stage - The stage.
+ */
+void stats_end_stage(StatsStage stage) {
+    double now;
+
+    hw_counters_end_stage(stage);
+    if (statsFormat == STATS_OFF && !traceEnabled) {
+        return;
+    }
+    now = stats_wall_seconds();
+    if (traceEnabled) {
+        trace_span(statsStageNames[stage], "stage", stageWallStart, now);
+        if (GetNumOfErrors() > stageErrorsStart) {
+            trace_instant(statsStageNames[stage], "errors",
+                          GetNumOfErrors() - stageErrorsStart);
+        }
+    }
+    if (statsFormat == STATS_OFF) {
+        return;
+    }
+    currentFile.wallSeconds[stage] += now - stageWallStart;
+    currentFile.cpuSeconds[stage] += cpuSeconds() - stageCpuStart;
+}
+/******************************************************************************/
+/**
+ * Writes the statistics of a file, or the total of the files, as a JSON
+ * object.
+ *
+ * @param out - The file of the JSON report.
+ * @param name - The name of the file, or NULL for the total.
+ * @param stats - The statistics.
+ */
+void printJsonStats(FILE *out, const char *name, const FileStats *stats) {
+    int i;
+
+    fprintf(out, "{");
+    if (name != NULL) {
+        fprintf(out, "\"file\": ");
+        fprint_json_string(out, name);
+        fprintf(out, ", ");
+    } else {
+        fprintf(out, "\"files\": %d, ", numOfFiles);
+    }
+    fprintf(out, "\"stages\": {");
+    for (i = 0; i < NUM_OF_STATS_STAGES; i++) {
+        fprintf(out, "%s\"%s\": {\"wall_ms\": %.3f, \"cpu_ms\": %.3f}",
+                i > 0 ? ", " : "", statsStageNames[i],
+                stats->wallSeconds[i] * 1000, stats->cpuSeconds[i] * 1000);
+    }
+    fprintf(out, "}");
+    for (i = 0; i < NUM_OF_STATS; i++) {
+        fprintf(out, ", \"%s\": %ld", statsCounterNames[i],
+                stats->counters[i]);
+    }
+    fprintf(out, "}");
+}
+/******************************************************************************/
+/**
+ * Keeps the statistics of a file for the JSON report, written at the end of
+ * the run.
+ *
+ * @param name - The name of the file.
+ * @param stats - The statistics.
+ */
+void keepJsonStats(const char *name, const FileStats *stats) {
+    FileStats *kept = NULL;
+
+    if (numOfFiles == reportedFilesCapacity) {
+        reportedFilesCapacity = reportedFilesCapacity > 0
+                                ? reportedFilesCapacity * 2 : 16;
+        kept = my_realloc(reportedFiles,
+                          sizeof(FileStats) * reportedFilesCapacity);
+        if (kept == NULL) {
+            printf("Error: Memory allocation for the statistics was "
+                   "failed!\n");
+            exit(1);
+        }
+        reportedFiles = kept;
+    }
+    kept = &reportedFiles[numOfFiles];
+    *kept = *stats;
+    kept->name = my_malloc(strlen(name) + 1);
+    if (kept->name == NULL) {
+        printf("Error: Memory allocation for the statistics was failed!\n");
+        exit(1);
+    }
+    strcpy(kept->name, name);
+}
+/******************************************************************************/
+/**
+ * Reports the statistics of a file, or the total of the files, as text.
+ *
+ * @param name - The name of the file, or NULL for the total.
+ * @param stats - The statistics.
+ */
+void printStats(const char *name, const FileStats *stats) {
+    int i;
+
+    if (name != NULL) {
+        fprintf(stderr, "Statistics of %s:\n", name);
+    } else {
+        fprintf(stderr, "Statistics of all %d files:\n", numOfFiles);
+    }
+    fprintf(stderr, "  %-20s %12s %12s\n", "stage", "wall ms", "cpu ms");
+    for (i = 0; i < NUM_OF_STATS_STAGES; i++) {
+        fprintf(stderr, "  %-20s %12.3f %12.3f\n", statsStageNames[i],
+                stats->wallSeconds[i] * 1000, stats->cpuSeconds[i] * 1000);
+    }
+    for (i = 0; i < NUM_OF_STATS; i++) {
+        fprintf(stderr, "  %-20s %12ld\n", statsCounterNames[i],
+                stats->counters[i]);
+    }
+}
+/******************************************************************************/
+/**
+ * Ends the statistics of a file: records its sizes, reports it and adds it
+ * to the total.
+ *
+ * @param file_name - The name of the file.
+ * @param lines - The number of lines of its .am file.
+ * @param labels - The number of its labels.
+ * @param IC - The number of its instruction words.
+ * @param DC - The number of its data words.
+ */
+void stats_end_file(const char *file_name, int lines, int labels, int IC,
+                    int DC) {
+    int i;
+
+    hw_counters_add_lines(lines);
+    trace_span(file_name, "file", fileWallStart, stats_wall_seconds());
+    if (statsFormat == STATS_OFF) {
+        return;
+    }
+    memcpy(currentFile.counters, statsCounters, sizeof(statsCounters));
+    currentFile.counters[STAT_LINES] = lines;
+    currentFile.counters[STAT_LABELS] = labels;
+    currentFile.counters[STAT_IC] = IC;
+    currentFile.counters[STAT_DC] = DC;
+
+    if (statsFormat == STATS_JSON) {
+        keepJsonStats(file_name, &currentFile);
+    } else {
+        printStats(file_name, &currentFile);
+    }
+
+    for (i = 0; i < NUM_OF_STATS_STAGES; i++) {
+        totalFiles.wallSeconds[i] += currentFile.wallSeconds[i];
+        totalFiles.cpuSeconds[i] += currentFile.cpuSeconds[i];
+    }
+    for (i = 0; i < NUM_OF_STATS; i++) {
+        totalFiles.counters[i] += currentFile.counters[i];
+    }
+    numOfFiles++;
+}
+/******************************************************************************/
+/**
+ * Returns the name of a stage, as it is reported.
+ *
+ * @param stage - The stage.
+ */
+const char *stats_stage_name(StatsStage stage) {
+    return statsStageNames[stage];
+}
+/******************************************************************************/
+/**
+ * Reports the total of all the files. The file of the JSON report is created
+ * now, and written with the files kept by stats_end_file.
+ *
+ * @return SUCCESS if the report was written, FAILURE if its file couldn't be
+ *         created.
+ */
+Status stats_end_run(void) {
+    Status ret = SUCCESS;
+    FILE *outputFile = NULL;
+    int i;
+
+    hw_counters_report();
+    if (statsFormat == STATS_TEXT) {
+        printStats(NULL, &totalFiles);
+    } else if (statsFormat == STATS_JSON) {
+        outputFile = fopen(statsJsonFile, "w");
+        if (outputFile == NULL) {
+            printf("Error: Couldn't create the statistics file '%s'.\n",
+                   statsJsonFile);
+            ret = FAILURE;
+        } else {
+            fprintf(outputFile, "{\"files\": [");
+            for (i = 0; i < numOfFiles; i++) {
+                fprintf(outputFile, "%s", i > 0 ? ", " : "");
+                printJsonStats(outputFile, reportedFiles[i].name,
+                               &reportedFiles[i]);
+            }
+            fprintf(outputFile, "], \"total\": ");
+            printJsonStats(outputFile, NULL, &totalFiles);
+            fprintf(outputFile, "}\n");
+            fclose(outputFile);
+        }
+        for (i = 0; i < numOfFiles; i++) {
+            my_free(reportedFiles[i].name);
+        }
+        my_free(reportedFiles);
+        reportedFiles = NULL;
+        reportedFilesCapacity = 0;
+    }
+    return ret;
+}
+/******************************************************************************/
@@ -0,0 +1,137 @@
+/*********************************FILE__HEADER*********************************\
+* File:					stats.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			API of the run statistics (--stats). The wall and CPU
+*                       time of each stage of the assembler are measured for
+*                       every file, along with counters of its input, output
+*                       and hot paths, and reported per file and in total as
+*                       text to stderr, or as JSON to a file of its own.
+*
+*                       The counters are plain global integers, incremented by
+*                       the STATS_ADD and STATS_COUNT macros without a branch
+*                       or a call, and only read when --stats is given. Built
+*                       with -DNO_STATS, the macros compile to nothing, and
+*                       only the timings and the sizes of the files are
+*                       reported.
+*
+*                       The stages are also where the hardware counters
+*                       (--hw-counters, see hw_counters.h) are started and
+*                       stopped, and where the files and the stages are
+*                       traced (--trace, see trace.h).
+\******************************************************************************/
+
+#ifndef MAMAN14_STATS_H
+#define MAMAN14_STATS_H
+
+#include "utils.h" /* for the Status enum */
+
+/***************************** Enums  Definitions *****************************/
+/* The formats of the report */
+typedef enum {
+    STATS_OFF,
+    STATS_TEXT, /* --stats */
+    STATS_JSON /* --stats=json:<file> */
+} StatsFormat;
+
+/* The timed stages of the assembler */
+typedef enum {
+    STATS_STAGE_PRE_PROCESS,
+    STATS_STAGE_CHECK_LABELS,
+    STATS_STAGE_PARSE, /* ParseFile and ResolveFixups */
+    STATS_STAGE_WRITE_LABELS, /* WriteLabelsToFile */
+    STATS_STAGE_OUTPUT, /* The output encoders and the binary object */
+    NUM_OF_STATS_STAGES
+} StatsStage;
+
+/* The counters of a file */
+typedef enum {
+    STAT_BYTES_READ,
+    STAT_BYTES_WRITTEN,
+    STAT_MACROS_DEFINED,
+    STAT_MACROS_EXPANDED,
+    STAT_SYMBOL_LOOKUPS, /* Lookups of labels and macros by name */
+    STAT_STRING_COMPARISONS, /* The names compared by the lookups of labels,
+                              * macros, commands, registers and directives */
+    STAT_LINES, /* The lines of the .am file */
+    STAT_LABELS,
+    STAT_IC,
+    STAT_DC,
+    NUM_OF_STATS
+} StatsCounter;
+
+/***************************** Global Definitions *****************************/
+/* The counters of the file being processed */
+extern long statsCounters[NUM_OF_STATS];
+
+#ifdef NO_STATS
+#define STATS_ADD(counter, n) ((void) 0)
+#else
+#define STATS_ADD(counter, n) ((void) (statsCounters[counter] += (long) (n)))
+#endif
+
+#define STATS_COUNT(counter) STATS_ADD(counter, 1)
+
+/************************* Functions Declarations *************************/
+/**
+ * Enables the statistics, reported in the given format.
+ *
+ * @param format - The format of the report, or STATS_OFF.
+ * @param json_file - The file of the JSON report, created by stats_end_run,
+ *                    or NULL for another format.
+ */
+void stats_enable(StatsFormat format, const char *json_file);
+
+/**
+ * Starts the statistics of a file, clearing the counters.
+ */
+void stats_begin_file(void);
+
+/**
+ * Starts timing a stage of the file.
+ *
+ * @param stage - The stage.
+ */
+void stats_start_stage(StatsStage stage);
+
+/**
+ * Stops timing a stage of the file, adding its time to the file.
+ *
+ * @param stage - The stage.
+ */
+void stats_end_stage(StatsStage stage);
+
+/**
+ * Ends the statistics of a file: records its sizes, reports it and adds it
+ * to the total.
+ *
+ * @param file_name - The name of the file.
+ * @param lines - The number of lines of its .am file.
+ * @param labels - The number of its labels.
+ * @param IC - The number of its instruction words.
+ * @param DC - The number of its data words.
+ */
+void stats_end_file(const char *file_name, int lines, int labels, int IC,
+                    int DC);
+
+/**
+ * Reports the total of all the files, and writes the JSON report.
+ *
+ * @return SUCCESS if the report was written, FAILURE if its file couldn't be
+ *         created.
+ */
+Status stats_end_run(void);
+
+/**
+ * Returns the wall time, in seconds from an arbitrary point.
+ */
+double stats_wall_seconds(void);
+
+/**
+ * Returns the name of a stage, as it is reported.
+ *
+ * @param stage - The stage.
+ */
+const char *stats_stage_name(StatsStage stage);
+
+#endif
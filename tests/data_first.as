@@ -0,0 +1,12 @@
+; Data and code may be interleaved: the data is loaded after all the code,
+; and the data labels are rebased past it
+.entry LIST
+.entry MAIN
+LIST: .data 7, -57, 17
+MAIN: lea LIST, @r1
+STR: .string "hi"
+ add LIST, @r2
+ prn STR
+COUNT: .data 3
+ cmp COUNT, 1
+ stop
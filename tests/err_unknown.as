@@ -0,0 +1,7 @@
+MAIN: foo @r1
+LOOP: mov @r3, LENGTH
+movv @r2, @r3
+prn -5
+bne LOOP
+stop
+LENGTH: .data 6, -9, 15
@@ -0,0 +1,4 @@
+MAIN: lea TABLE, @r3
+clear2
+stop
+.include "include_table.as"
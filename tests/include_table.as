@@ -0,0 +1,6 @@
+; constants and macros shared by several modules
+mcro clear2
+clr @r1
+clr @r2
+endmcro
+TABLE: .data 1, 2, 3
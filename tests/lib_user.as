@@ -0,0 +1,5 @@
+MAIN: prn 5
+swap13
+LOOP: dec @r2
+bne LOOP
+halt
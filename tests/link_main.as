@@ -0,0 +1,11 @@
+; A module linked with link_util by the linker (make linker): its extern
+; labels are resolved to the entries of link_util
+.extern SUM
+.extern TOTAL
+.entry MAIN
+MAIN: mov COUNT, @r1
+ jsr SUM
+ add TOTAL, @r2
+ prn COUNT
+ stop
+COUNT: .data 4
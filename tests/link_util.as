@@ -0,0 +1,10 @@
+; The entries used by link_main. Linked after it, its code and data are
+; moved past those of link_main
+.entry SUM
+.entry TOTAL
+SUM: add VALUES, @r1
+ cmp TOTAL, @r1
+ bne SUM
+ rts
+VALUES: .data 1, 2, 3
+TOTAL: .data 6
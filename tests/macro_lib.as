@@ -0,0 +1,8 @@
+mcro swap13
+mov @r1, @r7
+mov @r3, @r1
+mov @r7, @r3
+endmcro
+mcro halt
+stop
+endmcro
@@ -0,0 +1,21 @@
+; Macros may invoke other macros, at any depth
+mcro inc_both
+ inc @r1
+ inc @r2
+endmcro
+mcro swap
+ mov @r1, @r3
+ mov @r2, @r1
+ mov @r3, @r2
+endmcro
+mcro step
+ inc_both
+ swap
+ inc_both
+endmcro
+MAIN: lea STR, @r6
+ step
+ step
+ prn @r1
+ stop
+STR: .string "ab"
@@ -0,0 +1,168 @@
+/*********************************FILE__HEADER*********************************\
+* File:					trace.c
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			Implementation of the trace of the run. The events are
+*                       written as a JSON object with a "traceEvents" array:
+*                       spans as complete ("X") events and the rest as instant
+*                       ("i") events, their times in microseconds from the
+*                       start of the trace. The file is only created once
+*                       the run is over, so a run that stops early leaves no
+*                       empty trace behind.
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+#include "stats.h" /* for stats_wall_seconds */
+
+/**************************** Structs  Definitions ****************************/
+/* A recorded event */
+typedef struct {
+    char name[TRACE_NAME_LENGTH];
+    const char *category;
+    double start; /* In seconds of stats_wall_seconds */
+    double duration; /* In seconds, for a span */
+    long count; /* For an instant event */
+    char phase; /* 'X' for a span, 'i' for an instant event */
+} TraceEvent;
+
+/******************* Global variable definitions ******************************/
+int traceEnabled = 0;
+
+static const char *traceFileName = NULL;
+static TraceEvent *traceRing = NULL;
+static long traceRecorded = 0; /* All the events recorded, dropped ones too */
+static double traceStart = 0;
+
+/************************* Functions  Implementations *************************/
+/**
+ * Enables the trace: allocates its ring buffer. The file is created by
+ * trace_write.
+ *
+ * @param file_name - The name of the trace file.
+ */
+void trace_enable(const char *file_name) {
+    traceFileName = file_name;
+    traceRing = my_malloc(sizeof(TraceEvent) * TRACE_RING_CAPACITY);
+    if (traceRing == NULL) {
+        printf("Error: Memory allocation for the trace was failed!\n");
+        exit(1);
+    }
+    traceStart = stats_wall_seconds();
+    traceEnabled = 1;
+}
+/******************************************************************************/
+/**
+ * Returns the next slot of the ring buffer, overwriting the oldest event once
+ * the ring is full.
+ */
+TraceEvent *nextTraceEvent(const char *name, const char *category) {
+    TraceEvent *event = &traceRing[traceRecorded++ % TRACE_RING_CAPACITY];
+
+    strncpy(event->name, name, TRACE_NAME_LENGTH - 1);
+    event->name[TRACE_NAME_LENGTH - 1] = '\0';
+    event->category = category;
+    return event;
+}
+/******************************************************************************/
+/**
+ * Records a span.
+ *
+ * @param name - The name of the span.
+ * @param category - The category of the span: "file" or "stage".
+ * @param start - When the span started, in seconds of stats_wall_seconds.
+ * @param end - When the span ended, in seconds of stats_wall_seconds.
+ */
+void trace_span(const char *name, const char *category, double start,
+                double end) {
+    TraceEvent *event;
+
+    if (!traceEnabled) {
+        return;
+    }
+    event = nextTraceEvent(name, category);
+    event->phase = 'X';
+    event->start = start;
+    event->duration = end - start;
+    event->count = 0;
+}
+/******************************************************************************/
+/**
+ * Records an instant event with a count.
+ *
+ * @param name - The name of the event.
+ * @param category - The category of the event: "macro" or "errors".
+ * @param count - The count of the event: the lines of a macro expansion, or
+ *                the errors of a stage.
+ */
+void trace_instant(const char *name, const char *category, long count) {
+    TraceEvent *event;
+
+    if (!traceEnabled) {
+        return;
+    }
+    event = nextTraceEvent(name, category);
+    event->phase = 'i';
+    event->start = stats_wall_seconds();
+    event->duration = 0;
+    event->count = count;
+}
+/******************************************************************************/
+/**
+ * Creates the trace file, writes the recorded events to it, closes it and
+ * frees the ring buffer.
+ *
+ * @return SUCCESS if the trace was written, FAILURE if its file couldn't be
+ *         created.
+ */
+Status trace_write(void) {
+    long first = 0, i;
+    TraceEvent *event;
+    FILE *traceFile = NULL;
+
+    if (!traceEnabled) {
+        return SUCCESS;
+    }
+    traceEnabled = 0;
+    traceFile = fopen(traceFileName, "w");
+    if (traceFile == NULL) {
+        printf("Error: Couldn't create the trace file '%s'.\n", traceFileName);
+        my_free(traceRing);
+        traceRing = NULL;
+        return FAILURE;
+    }
+    if (traceRecorded > TRACE_RING_CAPACITY) {
+        first = traceRecorded - TRACE_RING_CAPACITY;
+    }
+
+    fprintf(traceFile, "{\"traceEvents\": [\n");
+    fprintf(traceFile, "{\"name\": \"process_name\", \"ph\": \"M\", "
+                       "\"pid\": 1, \"tid\": 1, "
+                       "\"args\": {\"name\": \"assembler\"}}");
+    for (i = first; i < traceRecorded; i++) {
+        event = &traceRing[i % TRACE_RING_CAPACITY];
+        fprintf(traceFile, ",\n{\"name\": ");
+        fprint_json_string(traceFile, event->name);
+        fprintf(traceFile, ", \"cat\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, "
+                           "\"pid\": 1, \"tid\": 1", event->category,
+                event->phase, (event->start - traceStart) * 1e6);
+        if (event->phase == 'X') {
+            fprintf(traceFile, ", \"dur\": %.3f}", event->duration * 1e6);
+        } else {
+            fprintf(traceFile, ", \"s\": \"t\", \"args\": {\"count\": %ld}}",
+                    event->count);
+        }
+    }
+    fprintf(traceFile, "\n], \"displayTimeUnit\": \"ms\", "
+                       "\"otherData\": {\"dropped_events\": %ld}}\n", first);
+
+    fclose(traceFile);
+    my_free(traceRing);
+    traceRing = NULL;
+    return SUCCESS;
+}
+/******************************************************************************/
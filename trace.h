@@ -0,0 +1,78 @@
+/*********************************FILE__HEADER*********************************\
+* File:					trace.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			API of the trace of the run (--trace <file>). A span
+*                       is recorded for each file and for each stage of the
+*                       assembler timed by the statistics, and an instant
+*                       event for each large macro expansion and for each
+*                       stage that reported errors. The events are written at
+*                       exit in the Chrome trace event format, which the
+*                       Chrome tracing page and Perfetto display as a
+*                       timeline of the whole run.
+*
+*                       The events are recorded into a ring buffer allocated
+*                       once, when the trace is enabled, so recording an event
+*                       only copies it. When the ring is full the oldest
+*                       events are overwritten, and their number is written
+*                       with the trace.
+\******************************************************************************/
+
+#ifndef MAMAN14_TRACE_H
+#define MAMAN14_TRACE_H
+
+#include "utils.h" /* for the Status enum */
+
+/***************************** Global Definitions *****************************/
+/* The number of events the ring buffer holds */
+#define TRACE_RING_CAPACITY 16384
+
+/* The longest name of an event, longer names are cut */
+#define TRACE_NAME_LENGTH 64
+
+/* The fewest lines of a macro expansion recorded as an event */
+#define TRACE_LARGE_MACRO_LINES 16
+
+/* Whether the trace is enabled, checked before recording an event */
+extern int traceEnabled;
+
+/************************* Functions Declarations *************************/
+/**
+ * Enables the trace: allocates its ring buffer. The file is created by
+ * trace_write.
+ *
+ * @param file_name - The name of the trace file.
+ */
+void trace_enable(const char *file_name);
+
+/**
+ * Records a span.
+ *
+ * @param name - The name of the span.
+ * @param category - The category of the span: "file" or "stage".
+ * @param start - When the span started, in seconds of stats_wall_seconds.
+ * @param end - When the span ended, in seconds of stats_wall_seconds.
+ */
+void trace_span(const char *name, const char *category, double start,
+                double end);
+
+/**
+ * Records an instant event with a count.
+ *
+ * @param name - The name of the event.
+ * @param category - The category of the event: "macro" or "errors".
+ * @param count - The count of the event: the lines of a macro expansion, or
+ *                the errors of a stage.
+ */
+void trace_instant(const char *name, const char *category, long count);
+
+/**
+ * Creates the trace file, writes the recorded events to it, closes it and
+ * frees the ring buffer.
+ *
+ * @return SUCCESS if the trace was written, FAILURE if its file couldn't be
+ *         created.
+ */
+Status trace_write(void);
+
+#endif
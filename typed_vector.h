@@ -0,0 +1,151 @@
+/*********************************FILE__HEADER*********************************\
+* File:					typed_vector.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			A dynamic array storing its items by value, generated
+*                       for each item type by macros. Unlike the Vector, which
+*                       holds pointers to items allocated one by one, the items
+*                       of a typed vector lie next to each other in a single
+*                       array, which is allocated with malloc, or from an arena.
+*
+*                       A typed vector is declared in a header with
+*                           DECLARE_TYPED_VECTOR(Name, Type, prefix)
+*                       and its functions are defined in one source file with
+*                           DEFINE_TYPED_VECTOR(Name, Type, prefix)
+*                       Both are written without a semicolon after them.
+*                       They generate the struct Name and the functions:
+*                       prefix_init    - Initializes an empty vector.
+*                       prefix_reserve - Grows the array to a given capacity.
+*                       prefix_push    - Adds an item to the end.
+*                       prefix_append  - Adds several items to the end.
+*                       prefix_pop     - Removes the last item.
+*                       prefix_clear   - Empties the vector, keeping its array.
+*                       prefix_free    - Frees the array.
+\******************************************************************************/
+
+#ifndef MAMAN14_TYPED_VECTOR_H
+#define MAMAN14_TYPED_VECTOR_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "arena.h"
+#include "utils.h" /* for my_realloc */
+
+/***************************** Global Definitions *****************************/
+/* The capacity of the array of a typed vector when it is first allocated */
+#define TYPED_VECTOR_INITIAL_CAPACITY 16
+
+/**
+ * Declares the struct Name of a vector of Type items, and its functions.
+ *
+ * The array is allocated with malloc, or from the arena of the vector if it
+ * has one. An arena vector leaves its old array in the arena when it grows,
+ * and its items are released with the arena: it is initialized again after
+ * the arena is reset.
+ */
+#define DECLARE_TYPED_VECTOR(Name, Type, prefix)                               \
+typedef struct {                                                               \
+    Type *items; /* The items, next to each other */                           \
+    int size; /* The number of items */                                        \
+    int capacity; /* The number of items the array can hold */                 \
+    Arena *arena; /* The arena the array is allocated from, or NULL */         \
+} Name;                                                                        \
+                                                                               \
+void prefix##_init(Name *v, Arena *arena);                                     \
+void prefix##_reserve(Name *v, int capacity);                                  \
+Type *prefix##_push(Name *v, Type item);                                       \
+void prefix##_append(Name *v, Type *items, int count);                         \
+int prefix##_pop(Name *v, Type *item);                                         \
+void prefix##_clear(Name *v);                                                  \
+void prefix##_free(Name *v);
+
+/**
+ * Defines the functions of a vector declared by DECLARE_TYPED_VECTOR.
+ * In case of an memory allocation error the functions exit the program.
+ */
+#define DEFINE_TYPED_VECTOR(Name, Type, prefix)                                \
+/* Initializes an empty vector, its array is allocated on the first push */    \
+void prefix##_init(Name *v, Arena *arena) {                                    \
+    v->items = NULL;                                                           \
+    v->size = 0;                                                               \
+    v->capacity = 0;                                                           \
+    v->arena = arena;                                                          \
+}                                                                              \
+                                                                               \
+/* Grows the array to hold at least the given number of items */              \
+void prefix##_reserve(Name *v, int capacity) {                                 \
+    Type *new_items = NULL;                                                    \
+    if (capacity <= v->capacity) {                                             \
+        return;                                                                \
+    }                                                                          \
+    if (v->arena != NULL) {                                                    \
+        new_items = arena_alloc(v->arena, sizeof(Type) * capacity);            \
+        if (v->size > 0) {                                                     \
+            memcpy(new_items, v->items, sizeof(Type) * v->size);               \
+        }                                                                      \
+    } else {                                                                   \
+        new_items = my_realloc(v->items, sizeof(Type) * capacity);             \
+        if (new_items == NULL) {                                               \
+            fprintf(stderr, "Error reallocating memory for a vector!\n");      \
+            exit(1);                                                           \
+        }                                                                      \
+    }                                                                          \
+    v->items = new_items;                                                      \
+    v->capacity = capacity;                                                    \
+}                                                                              \
+                                                                               \
+/* Adds an item to the end, and returns a pointer to the stored item, valid */ \
+/* until the vector grows */                                                   \
+Type *prefix##_push(Name *v, Type item) {                                      \
+    if (v->size == v->capacity) {                                              \
+        prefix##_reserve(v, v->capacity > 0 ? v->capacity * 2                  \
+                                            : TYPED_VECTOR_INITIAL_CAPACITY);  \
+    }                                                                          \
+    v->items[v->size] = item;                                                  \
+    return &v->items[v->size++];                                               \
+}                                                                              \
+                                                                               \
+/* Adds count items to the end, growing the array at most once */             \
+void prefix##_append(Name *v, Type *items, int count) {                        \
+    int capacity = v->capacity > 0 ? v->capacity                               \
+                                   : TYPED_VECTOR_INITIAL_CAPACITY;            \
+    if (count <= 0) {                                                          \
+        return;                                                                \
+    }                                                                          \
+    while (capacity < v->size + count) {                                       \
+        capacity *= 2;                                                         \
+    }                                                                          \
+    prefix##_reserve(v, capacity);                                             \
+    memcpy(v->items + v->size, items, sizeof(Type) * count);                   \
+    v->size += count;                                                          \
+}                                                                              \
+                                                                               \
+/* Removes the last item, copying it to item unless it is NULL. */             \
+/* Returns 0 if the vector is empty, and 1 otherwise */                        \
+int prefix##_pop(Name *v, Type *item) {                                        \
+    if (v->size == 0) {                                                        \
+        return 0;                                                              \
+    }                                                                          \
+    v->size--;                                                                 \
+    if (item != NULL) {                                                        \
+        *item = v->items[v->size];                                             \
+    }                                                                          \
+    return 1;                                                                  \
+}                                                                              \
+                                                                               \
+/* Empties the vector, keeping its array for the next items */                \
+void prefix##_clear(Name *v) {                                                 \
+    v->size = 0;                                                               \
+}                                                                              \
+                                                                               \
+/* Frees the array of the vector, unless it belongs to an arena */            \
+void prefix##_free(Name *v) {                                                  \
+    if (v->arena == NULL) {                                                    \
+        my_free(v->items);                                                     \
+    }                                                                          \
+    prefix##_init(v, v->arena);                                                \
+}
+
+#endif
@@ -3,6 +3,7 @@
 * Author:				Daniel Brodsky & Lior Katav
 * Date:					August-2023
 * Description:		    This file includes utility functions to handle
+*                       counted memory allocations and
 *                       common string operations, including duplication of
 *                       strings, filtering of lines, conversion of strings
 *                       to lowercase and checking if a string starts with
@@ -16,8 +17,94 @@
 #include <ctype.h>
 
 #include "utils.h"
+#include "mem_report.h"
+
+/******************* Global variable definitions ******************************/
+/* The number of allocations made by my_malloc and my_realloc */
+static long numOfAllocations = 0;
+
+/* The size of a block, stored in front of it for the memory report. The
+ * union keeps the block aligned for any type */
+typedef union {
+    size_t size;
+    long l;
+    double d;
+    void *p;
+} AllocationHeader;
 
 /************************* Functions  Implementations *************************/
+/**
+ * Allocates memory with malloc, counting the allocation. The block is
+ * preceded by its size, so it must be freed with my_free.
+ *
+ * @param size - The number of bytes to allocate.
+ *
+ * @return A pointer to the allocated memory, or NULL if the allocation failed.
+ */
+void *my_malloc(size_t size) {
+    AllocationHeader *header = malloc(sizeof(AllocationHeader) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    numOfAllocations++;
+    header->size = size;
+    mem_record_allocation(0, size);
+    return header + 1;
+}
+/******************************************************************************/
+/**
+ * Reallocates memory allocated by my_malloc, counting the allocation.
+ *
+ * @param ptr - The memory to reallocate, or NULL.
+ * @param size - The new number of bytes.
+ *
+ * @return A pointer to the reallocated memory, or NULL if the allocation
+ *         failed, in which case ptr is left as it was.
+ */
+void *my_realloc(void *ptr, size_t size) {
+    AllocationHeader *header = NULL;
+    size_t old_size = 0;
+
+    if (ptr == NULL) {
+        return my_malloc(size);
+    }
+    header = (AllocationHeader *) ptr - 1;
+    old_size = header->size;
+    header = realloc(header, sizeof(AllocationHeader) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    numOfAllocations++;
+    header->size = size;
+    mem_record_allocation(old_size, size);
+    return header + 1;
+}
+/******************************************************************************/
+/**
+ * Frees memory allocated by my_malloc or my_realloc.
+ *
+ * @param ptr - The memory to free, or NULL.
+ */
+void my_free(void *ptr) {
+    AllocationHeader *header = NULL;
+
+    if (ptr == NULL) {
+        return;
+    }
+    header = (AllocationHeader *) ptr - 1;
+    mem_record_free(header->size);
+    free(header);
+}
+/******************************************************************************/
+/**
+ * Returns the number of allocations made by my_malloc and my_realloc so far.
+ *
+ * @return The number of allocations.
+ */
+long get_num_of_allocations(void) {
+    return numOfAllocations;
+}
+/******************************************************************************/
 /**
  * Duplicates a given string.
  *
@@ -30,7 +117,7 @@ char *my_strdup(const char *s) {
     size_t len = strlen(s) + 1;
 
     /* Allocate memory for the new string */
-    char *new_str = (char *) malloc(len);
+    char *new_str = (char *) my_malloc(len);
     if (new_str == NULL) {
         fprintf(stderr, "Error allocating memory\n");
         exit(1);
@@ -92,4 +179,25 @@ int startsWith(const char *str, const char *prefix) {
     /* Compare the prefix length of the string with the prefix */
     return strncmp(str, prefix, strlen(prefix)) == 0;
 }
-/******************************************************************************/
\ No newline at end of file
+/******************************************************************************/
+/**
+ * Writes a string as a JSON string, escaping its quotes, backslashes and
+ * control characters.
+ *
+ * @param out - The file to write to.
+ * @param str - The string.
+ */
+void fprint_json_string(FILE *out, const char *str) {
+    fputc('"', out);
+    for (; *str != '\0'; str++) {
+        if (*str == '"' || *str == '\\') {
+            fprintf(out, "\\%c", *str);
+        } else if ((unsigned char) *str < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned char) *str);
+        } else {
+            fputc(*str, out);
+        }
+    }
+    fputc('"', out);
+}
+/******************************************************************************/
@@ -9,6 +9,9 @@
 #ifndef MAMAN14_UTILS_H
 #define MAMAN14_UTILS_H
 
+#include <stdio.h> /* for FILE */
+#include <stddef.h> /* for size_t */
+
 /**
  * An enum representing function return statuses.
  */
@@ -25,6 +28,36 @@ typedef enum {
     TRUE /**< Represents a boolean True value */
 } Boolean;
 
+/**
+ * Allocates memory with malloc, counting the allocation.
+ *
+ * @param size - The number of bytes to allocate.
+ * @return - A pointer to the allocated memory, or NULL if the allocation failed.
+ */
+void *my_malloc(size_t size);
+
+/**
+ * Reallocates memory with realloc, counting the allocation.
+ *
+ * @param ptr - The memory to reallocate, or NULL.
+ * @param size - The new number of bytes.
+ * @return - A pointer to the reallocated memory, or NULL if the allocation failed.
+ */
+void *my_realloc(void *ptr, size_t size);
+
+/**
+ * Frees memory allocated by my_malloc or my_realloc.
+ *
+ * @param ptr - The memory to free, or NULL.
+ */
+void my_free(void *ptr);
+
+/**
+ * Returns the number of allocations made by my_malloc and my_realloc so far.
+ * Used to check that assembling a file in steady state allocates nothing.
+ */
+long get_num_of_allocations(void);
+
 /**
  * Duplicates a string.
  *
@@ -57,4 +90,13 @@ void to_lowercase(char *str);
  */
 int startsWith(const char *str, const char *prefix);
 
+/**
+ * Writes a string as a JSON string, escaping its quotes, backslashes and
+ * control characters.
+ *
+ * @param out - The file to write to.
+ * @param str - The string.
+ */
+void fprint_json_string(FILE *out, const char *str);
+
 #endif
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include <stdio.h>
 
 #include "vector.h"
+#include "utils.h" /* for my_malloc */
 /************************* Functions  Implementations *************************/
 /**
  * Allocates and initializes a new Vector.
@@ -25,7 +26,7 @@
  */
 Vector *new_vector() {
     /* Allocate memory for a new Vector */
-    Vector *v = malloc(sizeof(Vector));
+    Vector *v = my_malloc(sizeof(Vector));
 
     /* Check if malloc failed */
     if (v == NULL) {
@@ -38,12 +39,12 @@ Vector *new_vector() {
     v->size = 0;
 
     /* Allocate memory for the items array */
-    v->items = malloc(sizeof(char *) * v->capacity);
+    v->items = my_malloc(sizeof(char *) * v->capacity);
 
     /* Check if malloc failed */
     if (v->items == NULL) {
         fprintf(stderr, "Error allocating memory for vector items\n");
-        free(v); /*  free v to avoid a memory leak */
+        my_free(v); /*  free v to avoid a memory leak */
         exit(1);
     }
 
@@ -63,7 +64,7 @@ void push_back(Vector *v, void *value) {
     if (v->size == v->capacity) {
         v->capacity *= 2;
         /* Reallocate memory for the items array */
-        new_items = realloc(v->items, sizeof(void *) * v->capacity);
+        new_items = my_realloc(v->items, sizeof(void *) * v->capacity);
         /* If the reallocation failed, print an error message and exit */
         if (new_items == NULL) {
             fprintf(stderr, "Error reallocating memory for a vector!\n");
@@ -85,11 +86,51 @@ void free_vector(Vector *v) {
     int i = 0;
     /* Free each item in the items array */
     for (; i < v->size; ++i) {
-        free(v->items[i]);
+        my_free(v->items[i]);
     }
 
     /* Free the items array and the vector itself */
-    free(v->items);
-    free(v);
+    my_free(v->items);
+    my_free(v);
 }
-/******************************************************************************/
\ No newline at end of file
+/******************************************************************************/
+/**
+ * Frees the memory used by the vector, but not the items it points to.
+ *
+ * @param v - The vector.
+ */
+void free_vector_shallow(Vector *v) {
+    /* Free the items array and the vector itself */
+    my_free(v->items);
+    my_free(v);
+}
+/******************************************************************************/
+/**
+ * Empties the vector, keeping its memory. The items are not freed.
+ *
+ * @param v - The vector.
+ */
+void reset_vector(Vector *v) {
+    v->size = 0;
+}
+/******************************************************************************/
+/**
+ * Grows the items array of the vector to at least the given capacity.
+ *
+ * @param v - The vector.
+ * @param capacity - The number of items the vector should be able to hold.
+ */
+void reserve_vector(Vector *v, int capacity) {
+    void **new_items = NULL;
+    if (capacity <= v->capacity) {
+        return;
+    }
+    new_items = my_realloc(v->items, sizeof(void *) * capacity);
+    if (new_items == NULL) {
+        fprintf(stderr, "Error reallocating memory for a vector!\n");
+        exit(1);
+    }
+    v->items = new_items;
+    v->capacity = capacity;
+}
+/******************************************************************************/
@@ -45,4 +45,30 @@ void push_back(Vector *v, void *value);
  */
 void free_vector(Vector *v);
 
+/**
+ * Frees the memory used by the vector, without freeing its items.
+ * Used for vectors that only refer to items owned by another structure.
+ *
+ * @param v - The vector.
+ */
+void free_vector_shallow(Vector *v);
+
+/**
+ * Empties the vector without freeing its items or its memory, so it can be
+ * filled again without reallocating.
+ *
+ * @param v - The vector.
+ */
+void reset_vector(Vector *v);
+
+/**
+ * Makes sure the vector can hold at least the given number of items, so that
+ * adding them doesn't reallocate it.
+ * In case of an memory allocation error the program will exit.
+ *
+ * @param v - The vector.
+ * @param capacity - The number of items the vector should be able to hold.
+ */
+void reserve_vector(Vector *v, int capacity);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,148 @@
+/*********************************FILE__HEADER*********************************\
+* File:					word_image.c
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			Implementation of the WordImage, a dynamic array of
+*                       12-bit machine words.
+\******************************************************************************/
+
+/******************************** Header Files ********************************/
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "word_image.h"
+#include "vector.h" /* for INITIAL_CAPACITY */
+#include "utils.h" /* for my_malloc */
+/************************* Functions  Implementations *************************/
+/**
+ * Allocates and initializes a new, empty WordImage.
+ * If memory allocation fails, the function prints an error message to stderr
+ * and exits with a status code of 1.
+ *
+ * @return a pointer to the newly created WordImage.
+ */
+WordImage *new_word_image() {
+    WordImage *image = my_malloc(sizeof(WordImage));
+    if (image == NULL) {
+        fprintf(stderr, "Error allocating memory for word image\n");
+        exit(1);
+    }
+
+    image->capacity = INITIAL_CAPACITY;
+    image->size = 0;
+    image->words = my_malloc(sizeof(unsigned short) * image->capacity);
+    if (image->words == NULL) {
+        fprintf(stderr, "Error allocating memory for word image words\n");
+        my_free(image);
+        exit(1);
+    }
+
+    return image;
+}
+/******************************************************************************/
+/**
+ * Adds a word to the end of the image, doubling its capacity when it is full.
+ *
+ * @param image - The word image.
+ * @param word - The word to be added, only its lower 12 bits are kept.
+ * @return The index of the added word.
+ */
+int push_word(WordImage *image, int word) {
+    unsigned short *new_words = NULL;
+    if (image->size == image->capacity) {
+        image->capacity *= 2;
+        new_words = my_realloc(image->words,
+                            sizeof(unsigned short) * image->capacity);
+        if (new_words == NULL) {
+            fprintf(stderr, "Error reallocating memory for a word image!\n");
+            exit(1);
+        }
+        image->words = new_words;
+    }
+
+    image->words[image->size] = (unsigned short) (word & WORD_MASK);
+    return image->size++;
+}
+/******************************************************************************/
+/**
+ * Adds a run of words to the end of the image, growing it at most once, so
+ * that bulk data can be written into place without checking each word.
+ *
+ * @param image - The word image.
+ * @param count - The number of words to add.
+ * @return A pointer to the first of the added words.
+ */
+unsigned short *append_words(WordImage *image, int count) {
+    int capacity = image->capacity;
+    if (image->size + count > capacity) {
+        while (image->size + count > capacity) {
+            capacity *= 2;
+        }
+        reserve_words(image, capacity);
+    }
+    image->size += count;
+    return image->words + image->size - count;
+}
+/******************************************************************************/
+/**
+ * Grows the capacity of the image to at least the given number of words.
+ *
+ * @param image - The word image.
+ * @param capacity - The number of words the image should be able to hold.
+ */
+void reserve_words(WordImage *image, int capacity) {
+    unsigned short *new_words = NULL;
+    if (capacity <= image->capacity) {
+        return;
+    }
+    new_words = my_realloc(image->words, sizeof(unsigned short) * capacity);
+    if (new_words == NULL) {
+        fprintf(stderr, "Error reallocating memory for a word image!\n");
+        exit(1);
+    }
+    image->words = new_words;
+    image->capacity = capacity;
+}
+/******************************************************************************/
+/**
+ * Empties the image, keeping its memory.
+ *
+ * @param image - The word image.
+ */
+void reset_word_image(WordImage *image) {
+    image->size = 0;
+}
+/******************************************************************************/
+/**
+ * Allocates a new Fixup from an arena and initializes it.
+ *
+ * @param arena - The arena to allocate the Fixup from.
+ * @param name - The label referred to.
+ * @param slot - The index of the word to patch, or -1 for an '.entry' directive.
+ * @param line_number - The line number in the .am file.
+ * @param origin_file - The included file of the line, or NULL.
+ * @param origin_line - The line number in origin_file.
+ * @return A pointer to the new Fixup.
+ */
+Fixup *new_fixup(Arena *arena, const char *name, int slot, int line_number,
+                 const char *origin_file, int origin_line) {
+    Fixup *fixup = arena_alloc(arena, sizeof(Fixup));
+    fixup->name = name;
+    fixup->slot = slot;
+    fixup->line_number = line_number;
+    fixup->origin_file = origin_file;
+    fixup->origin_line = origin_line;
+    fixup->label_index = -1;
+    return fixup;
+}
+/******************************************************************************/
+/**
+ * Frees the memory used by the word image.
+ *
+ * @param image - The word image.
+ */
+void free_word_image(WordImage *image) {
+    my_free(image->words);
+    my_free(image);
+}
+/******************************************************************************/
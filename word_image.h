@@ -0,0 +1,110 @@
+/*********************************FILE__HEADER*********************************\
+* File:					word_image.h
+* Author:				Daniel Brodsky & Lior Katav
+* Date:					August-2023
+* Description:			API of the WordImage, the in-memory image of the machine
+*                       words of a program, and of the Fixup records of the words
+*                       that refer to labels, which are patched once all the labels
+*                       are known.
+\******************************************************************************/
+
+#ifndef MAMAN14_WORD_IMAGE_H
+#define MAMAN14_WORD_IMAGE_H
+
+#include "arena.h" /* for the Arena struct */
+
+/***************************** Global Definitions *****************************/
+/* The address of the first word of a program */
+#define START_ADDRESS 100
+
+/* A machine word is 12 bits wide */
+#define WORD_MASK 0xFFF
+
+/**************************** Structs  Definitions ****************************/
+/* The machine words of a program, in the order of their addresses */
+typedef struct {
+    unsigned short *words; /* Dynamic array of words */
+    int size; /* Current number of words */
+    int capacity; /* Current capacity of the array */
+} WordImage;
+
+/* A reference to a label, resolved once all the labels of the program are known */
+typedef struct {
+    const char *name; /* The label, refers to the words of a tokenized line */
+    int slot; /* The index of the word to patch, or -1 for an '.entry' directive */
+    int line_number; /* The line number in the .am file */
+    const char *origin_file; /* The included file of the line, or NULL */
+    int origin_line; /* The line number in origin_file */
+    int label_index; /* The index of the label in the program's labels once resolved, or -1 */
+} Fixup;
+
+/************************* Functions Declarations *************************/
+
+/**
+ * Creates a new, empty word image.
+ *
+ * @return A pointer to the newly created word image.
+ */
+WordImage *new_word_image();
+
+/**
+ * Adds a word to the end of the image.
+ * In case of an memory allocation error the program will exit.
+ *
+ * @param image - The word image.
+ * @param word - The word to be added, only its lower 12 bits are kept.
+ * @return The index of the added word.
+ */
+int push_word(WordImage *image, int word);
+
+/**
+ * Adds a run of words to the end of the image, to be filled by the caller.
+ * In case of an memory allocation error the program will exit.
+ *
+ * @param image - The word image.
+ * @param count - The number of words to add.
+ * @return A pointer to the first of the added words. It is valid until the
+ *         next word is added to the image.
+ */
+unsigned short *append_words(WordImage *image, int count);
+
+/**
+ * Makes sure the image can hold at least the given number of words, so that
+ * adding them doesn't reallocate it.
+ * In case of an memory allocation error the program will exit.
+ *
+ * @param image - The word image.
+ * @param capacity - The number of words the image should be able to hold.
+ */
+void reserve_words(WordImage *image, int capacity);
+
+/**
+ * Empties the image, keeping its memory for the words of the next program.
+ *
+ * @param image - The word image.
+ */
+void reset_word_image(WordImage *image);
+
+/**
+ * Creates a new Fixup in an arena.
+ * In case of an memory allocation error the program will exit.
+ *
+ * @param arena - The arena to allocate the Fixup from.
+ * @param name - The label referred to.
+ * @param slot - The index of the word to patch, or -1 for an '.entry' directive.
+ * @param line_number - The line number in the .am file.
+ * @param origin_file - The included file of the line, or NULL.
+ * @param origin_line - The line number in origin_file.
+ * @return A pointer to the new Fixup, released with the arena.
+ */
+Fixup *new_fixup(Arena *arena, const char *name, int slot, int line_number,
+                 const char *origin_file, int origin_line);
+
+/**
+ * Frees the memory used by the word image.
+ *
+ * @param image - The word image.
+ */
+void free_word_image(WordImage *image);
+
+#endif